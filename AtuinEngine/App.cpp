@@ -59,6 +59,7 @@ void App::StartUp() {
 
     std::srand( (U32)std::time(nullptr));
 
+    pFiles->StartUp();
     pLog->StartUp();
     pJobs->StartUp();
 
@@ -84,6 +85,8 @@ void App::ShutDown() {
     std::cout << "Total used memory : " << pMemory->MaxUsedMemory() << '\n';
 
     pConfig->Save();
+    // pending writes go first, the logger appends its remaining messages after them
+    pFiles->ShutDown();
     pLog->ShutDown();
     pJobs->ShutDown(); 
 }
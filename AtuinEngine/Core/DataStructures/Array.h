@@ -216,6 +216,8 @@ public:
 
     Array();
     Array(Size capacity);
+    // all memory of the array is taken from the given allocator, e.g. the frame memory for transient arrays
+    explicit Array(IAllocator *allocator);
     Array(Size capacity, const T &value);
     Array(const std::initializer_list<T> &list);
 
@@ -232,6 +234,7 @@ public:
     bool IsEmpty() const { return mSize == 0; }
     Size GetSize() const { return mSize; }
     Size GetCapacity() const { return mCapacity; }
+    IAllocator* GetAllocator() const { return mMemory.Allocator(); }
 
     void Clear();
     void Reserve(Size capacity);
@@ -321,6 +324,10 @@ Array<T>::Array(Size capacity) : mSize {0}, mCapacity {capacity}, pData {nullptr
 }
 
 
+template<typename T>
+Array<T>::Array(IAllocator *allocator) : mSize {0}, mCapacity {0}, pData {nullptr}, mLog(), mMemory(allocator) {}
+
+
 template<typename T>
 Array<T>::Array(Size capacity, const T &value) : mSize {capacity}, mCapacity {capacity}, pData {nullptr}, mLog(), mMemory() {
     
@@ -450,12 +457,17 @@ void Array<T>::Reserve(Size capacity) {
     }
     else
     {
-        Array<T> temp(capacity);
+        // move elements into new storage taken from the same allocator
+        T *newData = static_cast<T*>( mMemory.Allocate( capacity * sizeof(T), alignof(T)) );
         for (Size i = 0; i < mSize; i++)
         {
-            temp.PushBack( std::move(pData[i]) );
+            new (newData + i) T( std::move(pData[i]) );
+            pData[i].~T();
         }
-        *this = std::move(temp);
+
+        Free();
+        pData = newData;
+        mCapacity = capacity;
     }
 }
 
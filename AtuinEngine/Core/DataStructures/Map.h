@@ -15,6 +15,8 @@ namespace Atuin {
 
 /*
     KeyType is any type for which the standard hash struct template is implemented
+    Buckets and nodes are taken from the given allocator, or the MemoryManager if none is given.
+    Nodes are freed one by one, so the allocator has to support freeing in arbitrary order.
 */
 template<typename KeyType, typename ValueType>
 class Map {
@@ -129,7 +131,8 @@ public:
 
 public:
     Map();
-    Map(Size numBuckets, float maxLoadFactor);
+    explicit Map(IAllocator *allocator);
+    Map(Size numBuckets, float maxLoadFactor, IAllocator *allocator = nullptr);
     Map(const Map &other);
     Map(Map &&other);
 
@@ -142,6 +145,7 @@ public:
     Size GetSize() const { return mSize; }
     Size GetNumBuckets() const { return mNumBuckets; }
     float GetMaxLoadFactor() const { return mMaxLoadFactor; }
+    IAllocator* GetAllocator() const { return mMemory.Allocator(); }
 
     iterator Find(const KeyType &key);
     const_iterator Find(const KeyType &key) const;
@@ -190,15 +194,19 @@ Map<KeyType, ValueType>::Map() :
 
 
 template<typename KeyType, typename ValueType>
-Map<KeyType, ValueType>::Map(Size numBuckets, float maxLoadFactor) : 
-    mBuckets(numBuckets, nullptr), 
+Map<KeyType, ValueType>::Map(IAllocator *allocator) : Map(64, 1.0f, allocator) {}
+
+
+template<typename KeyType, typename ValueType>
+Map<KeyType, ValueType>::Map(Size numBuckets, float maxLoadFactor, IAllocator *allocator) : 
+    mBuckets(allocator), 
     mNumBuckets {numBuckets}, 
     mSize {0},
     mMaxLoadFactor {maxLoadFactor},
     mLog(), 
-    mMemory() 
+    mMemory(allocator) 
 {
-    
+    mBuckets.Resize(mNumBuckets, nullptr);
 }
 
 
@@ -253,7 +261,8 @@ Map<KeyType, ValueType>& Map<KeyType, ValueType>::operator=(const Map &rhs) {
 
         mNumBuckets = rhs.mNumBuckets;
         mMaxLoadFactor = rhs.mMaxLoadFactor;    
-        mBuckets = Array<MapData*>(mNumBuckets, nullptr); 
+        mBuckets.Clear();
+        mBuckets.Resize(mNumBuckets, nullptr);
         for (Size i = 0; i < rhs.mNumBuckets; i++)
         {
             MapData *head = rhs.mBuckets[i];
@@ -469,7 +478,8 @@ void Map<KeyType, ValueType>::Rehash() {
         return;
     }
 
-    Array<MapData*> newBuckets(2*mNumBuckets, nullptr);
+    Array<MapData*> newBuckets( mMemory.Allocator());
+    newBuckets.Resize(2*mNumBuckets, nullptr);
     for (Size i = 0; i < mNumBuckets; i++)
     {
         MapData *head = mBuckets[i];
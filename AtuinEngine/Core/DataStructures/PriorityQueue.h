@@ -23,6 +23,7 @@ public:
 
     PriorityQueue();
     PriorityQueue(Size capacity);
+    explicit PriorityQueue(IAllocator *allocator);
     PriorityQueue(const std::initializer_list<T> &list);
     PriorityQueue(const Array<T> &array);
     PriorityQueue(Array<T> &&array);
@@ -38,6 +39,7 @@ public:
 
     bool IsEmpty() { return mData.GetSize() == 0; }
     Size GetSize() { return mData.GetSize(); }
+    IAllocator* GetAllocator() const { return mData.GetAllocator(); }
 
     void Clear() { mData.Clear(); }
     void Push(const T &value);
@@ -74,6 +76,10 @@ template<typename T, class Compare>
 PriorityQueue<T,Compare>::PriorityQueue(Size capacity) : mData(capacity), mLog() {}
 
 
+template<typename T, class Compare>
+PriorityQueue<T,Compare>::PriorityQueue(IAllocator *allocator) : mData(allocator), mLog() {}
+
+
 template<typename T, class Compare>
 PriorityQueue<T,Compare>::PriorityQueue(const std::initializer_list<T> &list) : mData(list), mLog() {
 
@@ -22,6 +22,7 @@ public:
 
     Queue();
     Queue(Size capacity);
+    explicit Queue(IAllocator *allocator);
     Queue(const std::initializer_list<T> &list);
     Queue(const Array<T> &array);
     Queue(Array<T> &&array);
@@ -38,6 +39,7 @@ public:
 
     bool IsEmpty() const {return mSize == 0;}
     Size GetSize() const { return mSize; }
+    IAllocator* GetAllocator() const { return mData.GetAllocator(); }
 
     void Clear();
     void Push(const T &value);
@@ -74,6 +76,10 @@ Queue<T>::Queue(Size capacity) : mData(), mHead{0}, mTail{0}, mSize{0}, mLog() {
 }
 
 
+template<typename T>
+Queue<T>::Queue(IAllocator *allocator) : mData(allocator), mHead{0}, mTail{0}, mSize{0}, mLog() {}
+
+
 template<typename T>
 Queue<T>::Queue(const std::initializer_list<T> &list) : mData(list), mHead{0}, mTail{list.size()}, mSize{list.size()}, mLog() {}
 
@@ -245,7 +251,7 @@ const T& Queue<T>::Back() const {
 template<typename T>
 void Queue<T>::Expand() {
 
-    Array<T> temp;
+    Array<T> temp( mData.GetAllocator());
     temp.Resize( Math::NextPowerOfTwo(mData.GetCapacity()) );
     for (Size i = 0; i<mSize; i++)
     {
@@ -1,5 +1,5 @@
 
-#include "ConcurrentQueue.h"
+#include "WorkStealingQueue.h"
 
 
 namespace Atuin {
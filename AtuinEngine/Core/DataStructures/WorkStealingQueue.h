@@ -0,0 +1,282 @@
+#pragma once
+
+
+#include "Core/Util/Types.h"
+#include "Core/Util/Math.h"
+#include "Core/Memory/Memory.h"
+
+#include <atomic>
+#include <type_traits>
+
+
+namespace Atuin {
+
+
+/* @brief Chase-Lev work stealing deque.
+ *        The owning thread pushes and pops at the bottom (LIFO), any other thread steals from the top (FIFO).
+ *        If the ring buffer is full Push() moves the elements to a buffer of twice the size.
+ *        Replaced buffers are kept until the queue is destroyed, since a concurrent Steal() might still read from them.
+ *        Memory orderings follow Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+ */
+template<typename T>
+class WorkStealingQueue {
+
+    static_assert(std::is_trivially_copyable_v<T>, "WorkStealingQueue elements are stored in std::atomic and have to be trivially copyable.");
+
+
+    struct Buffer {
+
+        Size capacity;
+        std::atomic<T> *data;
+        // buffer this one replaced, freed with the queue
+        Buffer *previous;
+
+        T    Get(I64 index) const { return data[ Math::ModuloPowerOfTwo((U64)index, capacity) ].load(std::memory_order_relaxed); }
+        void Put(I64 index, const T &value) { data[ Math::ModuloPowerOfTwo((U64)index, capacity) ].store(value, std::memory_order_relaxed); }
+    };
+
+
+public:
+
+    WorkStealingQueue() = delete;
+    explicit WorkStealingQueue(Size capacity);
+
+    WorkStealingQueue(const WorkStealingQueue &other) = delete;
+    // moving is only safe while no other thread accesses either queue
+    WorkStealingQueue(WorkStealingQueue &&other);
+
+    WorkStealingQueue& operator= (const WorkStealingQueue &rhs) = delete;
+    WorkStealingQueue& operator= (WorkStealingQueue &&rhs);
+
+    ~WorkStealingQueue();
+
+
+    // only exact if no other thread accesses the queue
+    bool IsEmpty() const { return GetSize() == 0; }
+    Size GetSize() const;
+    Size GetCapacity() const { return pBuffer.load(std::memory_order_relaxed)->capacity; }
+
+    // Owner thread only. Returns false if the queue is full and a larger buffer could not be allocated.
+    bool Push(const T &value);
+    // Owner thread only.
+    bool Pop(T &out);
+    // Any thread.
+    bool Steal(T &out);
+
+
+private:
+
+    Buffer* CreateBuffer(Size capacity, Buffer *previous);
+    void    FreeBuffers();
+    Buffer* Grow(Buffer *buffer, I64 top, I64 bottom);
+
+
+    // top and bottom are written by different threads, keep them on separate cache lines
+    alignas(64) std::atomic<I64> mTop;
+    alignas(64) std::atomic<I64> mBottom;
+    alignas(64) std::atomic<Buffer*> pBuffer;
+
+    Memory mMemory;
+};
+
+
+template<typename T>
+WorkStealingQueue<T>::WorkStealingQueue(Size capacity) : mTop {0}, mBottom {0}, mMemory() {
+
+    assert(capacity > 0);
+
+    // ring indices are wrapped with a mask
+    if (!Math::IsPowerOfTwo(capacity))
+    {
+        capacity = Math::NextPowerOfTwo(capacity);
+    }
+
+    pBuffer.store( CreateBuffer(capacity, nullptr), std::memory_order_relaxed);
+    assert(pBuffer.load(std::memory_order_relaxed) != nullptr);
+}
+
+
+template<typename T>
+WorkStealingQueue<T>::WorkStealingQueue(WorkStealingQueue &&other) : mMemory(other.mMemory) {
+
+    mTop.store( other.mTop.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    mBottom.store( other.mBottom.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    pBuffer.store( other.pBuffer.exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+
+template<typename T>
+WorkStealingQueue<T>& WorkStealingQueue<T>::operator= (WorkStealingQueue &&rhs) {
+
+    if (this != &rhs)
+    {
+        FreeBuffers();
+
+        mMemory = rhs.mMemory;
+        mTop.store( rhs.mTop.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        mBottom.store( rhs.mBottom.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        pBuffer.store( rhs.pBuffer.exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    return *this;
+}
+
+
+template<typename T>
+WorkStealingQueue<T>::~WorkStealingQueue() {
+
+    FreeBuffers();
+}
+
+
+template<typename T>
+Size WorkStealingQueue<T>::GetSize() const {
+
+    I64 bottom = mBottom.load(std::memory_order_relaxed);
+    I64 top = mTop.load(std::memory_order_relaxed);
+
+    return bottom > top ? (Size)(bottom - top) : 0;
+}
+
+
+template<typename T>
+bool WorkStealingQueue<T>::Push(const T &value) {
+
+    I64 bottom = mBottom.load(std::memory_order_relaxed);
+    I64 top = mTop.load(std::memory_order_acquire);
+    Buffer *buffer = pBuffer.load(std::memory_order_relaxed);
+
+    if (bottom - top > (I64)buffer->capacity - 1)
+    {
+        buffer = Grow(buffer, top, bottom);
+        if (buffer == nullptr)
+        {
+            return false;
+        }
+    }
+
+    buffer->Put(bottom, value);
+
+    // the element has to be visible before a thief can see the new bottom
+    std::atomic_thread_fence(std::memory_order_release);
+    mBottom.store(bottom + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+
+template<typename T>
+bool WorkStealingQueue<T>::Pop(T &out) {
+
+    // reserve the bottom element before looking at top
+    I64 bottom = mBottom.load(std::memory_order_relaxed) - 1;
+    Buffer *buffer = pBuffer.load(std::memory_order_relaxed);
+    mBottom.store(bottom, std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    I64 top = mTop.load(std::memory_order_relaxed);
+
+    // queue was empty
+    if (top > bottom)
+    {
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    out = buffer->Get(bottom);
+
+    // more than one element left, no thief can reach this one
+    if (top < bottom)
+    {
+        return true;
+    }
+
+    // last element -> race thieves for it by moving top
+    bool success = mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    mBottom.store(bottom + 1, std::memory_order_relaxed);
+
+    return success;
+}
+
+
+template<typename T>
+bool WorkStealingQueue<T>::Steal(T &out) {
+
+    I64 top = mTop.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    I64 bottom = mBottom.load(std::memory_order_acquire);
+
+    if (top >= bottom)
+    {
+        return false;
+    }
+
+    // the element must be read before top is claimed, afterwards the owner may overwrite its slot
+    Buffer *buffer = pBuffer.load(std::memory_order_acquire);
+    T value = buffer->Get(top);
+
+    if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        // lost the race against another thief or the owner
+        return false;
+    }
+
+    out = value;
+    return true;
+}
+
+
+template<typename T>
+void WorkStealingQueue<T>::FreeBuffers() {
+
+    Buffer *buffer = pBuffer.exchange(nullptr, std::memory_order_relaxed);
+    while (buffer != nullptr)
+    {
+        Buffer *previous = buffer->previous;
+        // std::atomic<T> is trivially destructible, so the elements need no destructor calls
+        mMemory.Free(buffer->data);
+        mMemory.Delete(buffer);
+        buffer = previous;
+    }
+}
+
+
+template<typename T>
+typename WorkStealingQueue<T>::Buffer* WorkStealingQueue<T>::CreateBuffer(Size capacity, Buffer *previous) {
+
+    std::atomic<T> *data = static_cast<std::atomic<T>*>( mMemory.Allocate(capacity * sizeof(std::atomic<T>), alignof(std::atomic<T>)) );
+    if (data == nullptr)
+    {
+        return nullptr;
+    }
+    for (Size i = 0; i < capacity; i++)
+    {
+        new (data + i) std::atomic<T>();
+    }
+
+    return mMemory.template New<Buffer>( Buffer{capacity, data, previous} );
+}
+
+
+template<typename T>
+typename WorkStealingQueue<T>::Buffer* WorkStealingQueue<T>::Grow(Buffer *buffer, I64 top, I64 bottom) {
+
+    Buffer *newBuffer = CreateBuffer(2 * buffer->capacity, buffer);
+    if (newBuffer == nullptr)
+    {
+        return nullptr;
+    }
+
+    // indices stay the same, only their position in the ring changes
+    for (I64 i = top; i < bottom; i++)
+    {
+        newBuffer->Put(i, buffer->Get(i));
+    }
+
+    pBuffer.store(newBuffer, std::memory_order_release);
+
+    return newBuffer;
+}
+
+
+} // Atuin
@@ -124,8 +124,8 @@ void Logger::Debug(LogLevel level, LogChannel channel, std::string_view message,
     {
         writer.stream.flush();
  
-        // TODO use async write instead
-        mFiles.Write(writer.fileName, writer.stream.str(), std::ios::app);
+        // appends to the same file keep their order on the I/O threads
+        mFiles.WriteAsync(writer.fileName, writer.stream.str(), Task(), nullptr, std::ios::app, JobPriority::BACKGROUND);
 
         writer.stream.str("");
         writer.stream.clear();
@@ -2,23 +2,84 @@
 #include "FileManager.h"
 #include "Files.h"
 #include "EngineLoop.h"
+#include "Core/Config/ConfigManager.h"
 #include "Core/Debug/Logger.h"
+#include "Core/Jobs/CpuTopology.h"
 #include "Core/Util/StringFormat.h"
 
 #include <fstream>
 
-#include <iostream>
-
 
 namespace Atuin {
 
 
-FileManager::FileManager() : mRootPath {std::filesystem::current_path()}, mLog(), mJobs() {
+CVar<U32>* FileManager::pNumIOThreads = ConfigManager::RegisterCVar("Files", "NUM_IO_THREADS", 2U);
+
 
+FileManager::FileManager() : 
+    mRootPath {std::filesystem::current_path()}, 
+    mIOThreads(), 
+    mRequests(), 
+    mActiveFiles(), 
+    mActive {false}, 
+    mRequestLock(), 
+    mRequestCV(), 
+    mLog(), 
+    mJobs() 
+{
     Files::sFileManager = this;
 }
 
 
+FileManager::~FileManager() {
+
+    ShutDown();
+
+    if (Files::sFileManager == this)
+    {
+        Files::sFileManager = nullptr;
+    }
+}
+
+
+void FileManager::StartUp() {
+
+    Size numThreads = pNumIOThreads->Get();
+    mActiveFiles = Array<std::string>(numThreads);
+    for (Size i = 0; i < numThreads; i++)
+    {
+        mActiveFiles.EmplaceBack();
+    }
+    mActive = true;
+
+    mIOThreads.Reserve(numThreads);
+    for (Size i = 0; i < numThreads; i++)
+    {
+        mIOThreads.EmplaceBack(&FileManager::IOThread, this, i);
+    }
+}
+
+
+void FileManager::ShutDown() {
+
+    {
+        // lock mutex
+        const std::lock_guard<std::mutex> lock(mRequestLock);
+        mActive = false;
+    }
+    mRequestCV.notify_all();
+
+    for (Size i = 0; i < mIOThreads.GetSize(); i++)
+    {
+        if (mIOThreads[i].joinable())
+        {
+            mIOThreads[i].join();
+        }
+    }
+    mIOThreads.Clear();
+}
+
+
 void FileManager::MakeDir(std::string_view dirName) {
 
     std::filesystem::create_directory(dirName);
@@ -27,11 +88,23 @@ void FileManager::MakeDir(std::string_view dirName) {
 
 void FileManager::Read(std::string_view fileName, Array<char> &buffer, std::ios::openmode mode) {
 
-    auto filePath = mRootPath / fileName;
+    ReadFile(mRootPath, fileName, buffer, mode, mLog);
+}
+
+
+void FileManager::Write(std::string_view fileName, std::string_view buffer, std::ios::openmode mode) {
+
+    WriteFile(mRootPath, fileName, buffer, mode, mLog);
+}
+
+
+void FileManager::ReadFile(const std::filesystem::path &rootPath, std::string_view fileName, Array<char> &buffer, std::ios::openmode mode, const Log &log) {
+
+    auto filePath = rootPath / fileName;
     std::ifstream file(filePath, mode);
     if (!file.is_open())
     {
-        mLog.Error(LogChannel::FILES, FormatStr("Unable to open file : %s", fileName.data()));
+        log.Error(LogChannel::FILES, FormatStr("Unable to open file : %s", fileName.data()));
 
         return;
     }
@@ -44,28 +117,174 @@ void FileManager::Read(std::string_view fileName, Array<char> &buffer, std::ios:
     buffer.Resize(size);
     if (!file.read(buffer.Data(), size))
     {
-        mLog.Error(LogChannel::FILES, FormatStr("Unable to read file : %s", fileName.data()));
+        log.Error(LogChannel::FILES, FormatStr("Unable to read file : %s", fileName.data()));
         return;
     }
 }
 
 
-void FileManager::Write(std::string_view fileName, std::string_view buffer, std::ios::openmode mode) {
+void FileManager::WriteFile(const std::filesystem::path &rootPath, std::string_view fileName, std::string_view buffer, std::ios::openmode mode, const Log &log) {
 
-    auto filePath = mRootPath / fileName;
+    auto filePath = rootPath / fileName;
     std::ofstream file(filePath, mode);
     if (!file.is_open())
     {
-        mLog.Error(LogChannel::FILES, FormatStr("Unable to open file : %s", fileName.data()));
+        log.Error(LogChannel::FILES, FormatStr("Unable to open file : %s", fileName.data()));
         return;
     }
 
     if (!file.write(buffer.data(), buffer.length()))
     {
-        mLog.Error(LogChannel::FILES, FormatStr("Unable to write to file : %s", fileName.data()));
+        log.Error(LogChannel::FILES, FormatStr("Unable to write to file : %s", fileName.data()));
         return;
     }    
 }
 
 
+JobID FileManager::ReadAsync(std::string_view fileName, Array<char> &buffer, Task continuation, void *data, std::ios::openmode mode, JobPriority priority) {
+
+    IORequest request;
+    request.fileName = fileName;
+    request.readBuffer = &buffer;
+    request.mode = mode;
+
+    return Submit(std::move(request), std::move(continuation), data, priority);
+}
+
+
+JobID FileManager::WriteAsync(std::string_view fileName, std::string buffer, Task continuation, void *data, std::ios::openmode mode, JobPriority priority) {
+
+    IORequest request;
+    request.fileName = fileName;
+    request.writeBuffer = std::move(buffer);
+    request.mode = mode;
+
+    return Submit(std::move(request), std::move(continuation), data, priority);
+}
+
+
+JobID FileManager::Submit(IORequest &&request, Task continuation, void *data, JobPriority priority) {
+
+    if (!mJobs.Ready())
+    {
+        Execute(request);
+        if (continuation)
+        {
+            continuation(data);
+        }
+        return -1;
+    }
+
+    if (!continuation)
+    {
+        continuation = [](void*){};
+    }
+    // created up front, so that the caller can wait on it while the file operation is pending
+    request.job = mJobs.CreateJob(std::move(continuation), data, -1, priority);
+    JobID job = request.job;
+
+    {
+        // lock mutex
+        const std::lock_guard<std::mutex> lock(mRequestLock);
+        if (mActive && !mIOThreads.IsEmpty())
+        {
+            mRequests.PushBack( std::move(request));
+            mRequestCV.notify_one();
+            return job;
+        }
+    }
+
+    // not started or already shut down, the file is accessed on the calling thread
+    Complete(request);
+
+    return job;
+}
+
+
+void FileManager::IOThread(Size threadID) {
+
+    CpuTopology::SetCurrentThreadName( FormatStr("Atuin IO %d", (int)threadID) );
+
+    IORequest request;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mRequestLock);
+
+            // requests on the file this thread has just finished may start now
+            mActiveFiles[threadID].clear();
+            if (!mRequests.IsEmpty())
+            {
+                mRequestCV.notify_all();
+            }
+
+            bool found = false;
+            mRequestCV.wait(lock, [&]() {
+                found = PopRequest(threadID, request);
+                return found || (!mActive && mRequests.IsEmpty());
+            });
+            if (!found)
+            {
+                return;
+            }
+        }
+
+        Complete(request);
+    }
+}
+
+
+bool FileManager::PopRequest(Size threadID, IORequest &request) {
+
+    for (Size i = 0; i < mRequests.GetSize(); i++)
+    {
+        bool busy = false;
+        for (const std::string &file : mActiveFiles)
+        {
+            busy = busy || file == mRequests[i].fileName;
+        }
+
+        if (!busy)
+        {
+            request = std::move(mRequests[i]);
+            mRequests.Erase(i);
+            mActiveFiles[threadID] = request.fileName;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void FileManager::Execute(IORequest &request) {
+
+    if (request.readBuffer != nullptr)
+    {
+        Read(request.fileName, *request.readBuffer, request.mode);
+    }
+    else
+    {
+        Write(request.fileName, request.writeBuffer, request.mode);
+    }
+}
+
+
+void FileManager::Complete(IORequest &request) {
+
+    // a failed file operation must not keep waiting jobs from finishing
+    try
+    {
+        Execute(request);
+    }
+    catch (const std::exception &e)
+    {
+        // not Error(), it throws again and would end the I/O thread, failed opens and reads are already logged as errors
+        mLog.Warning(LogChannel::FILES, FormatStr("File request on %s failed : %s", request.fileName.c_str(), e.what()));
+    }
+
+    mJobs.Run(request.job);
+}
+
+
 } // Atuin
@@ -1,36 +1,90 @@
-
 #pragma once
 
 
 #include "Core/Util/Types.h"
+#include "Core/Config/CVar.h"
 #include "Core/Debug/Log.h"
 #include "Core/Jobs/Jobs.h"
 #include "Core/DataStructures/Array.h"
 
+#include <condition_variable>
 #include <filesystem>
+#include <mutex>
 #include <string>
+#include <thread>
 
 
 namespace Atuin {
 
 
+/* @brief Reads and writes files relative to the working directory.
+ *        The async versions hand the blocking file access to a few I/O threads, so that it never occupies a job worker,
+ *        and run a continuation job on the workers once the file operation has finished.
+ *        Requests on the same file are executed in the order they were made.
+ */
 class FileManager {
 
+
+struct IORequest {
+
+    std::string fileName;
+    // target of a read, nullptr for writes
+    Array<char> *readBuffer = nullptr;
+    std::string writeBuffer;
+    std::ios::openmode mode = std::ios::in;
+    // continuation, run once the file operation has finished
+    JobID job = -1;
+};
+
+
 public:
     FileManager();
-    ~FileManager() = default;
+    ~FileManager();
+
+    void StartUp();
+    // finishes all pending requests
+    void ShutDown();
 
     void MakeDir(std::string_view dirName);
 
     void Read(std::string_view fileName, Array<char> &buffer, std::ios::openmode mode = std::ios::in);
     void Write(std::string_view fileName, std::string_view buffer, std::ios::openmode mode = std::ios::out);
 
+    // Returns the continuation's job, waiting on it waits for the file operation as well. The buffer must stay alive until then.
+    // Without I/O threads the file is accessed on the calling thread, without JobManager the continuation is called directly and -1 returned.
+    JobID ReadAsync(std::string_view fileName, Array<char> &buffer, Task continuation = Task(), void *data = nullptr, 
+                    std::ios::openmode mode = std::ios::in, JobPriority priority = JobPriority::NORMAL);
+    JobID WriteAsync(std::string_view fileName, std::string buffer, Task continuation = Task(), void *data = nullptr, 
+                     std::ios::openmode mode = std::ios::out, JobPriority priority = JobPriority::NORMAL);
+
+    // blocking file access relative to rootPath, also used by Files when there is no FileManager
+    static void ReadFile(const std::filesystem::path &rootPath, std::string_view fileName, Array<char> &buffer, std::ios::openmode mode, const Log &log);
+    static void WriteFile(const std::filesystem::path &rootPath, std::string_view fileName, std::string_view buffer, std::ios::openmode mode, const Log &log);
+
 
 private:
 
+    static CVar<U32>* pNumIOThreads;
+
+
+    JobID Submit(IORequest &&request, Task continuation, void *data, JobPriority priority);
+    void  IOThread(Size threadID);
+    bool  PopRequest(Size threadID, IORequest &request);
+    void  Execute(IORequest &request);
+    void  Complete(IORequest &request);
+
     // absolute path to the executable
     std::filesystem::path mRootPath;
 
+    Array<std::thread> mIOThreads;
+    // pending requests in the order they were made
+    Array<IORequest> mRequests;
+    // per I/O thread the file it is working on, later requests on it wait
+    Array<std::string> mActiveFiles;
+    bool mActive;
+    std::mutex mRequestLock;
+    std::condition_variable mRequestCV;
+
     Log mLog;
     Jobs mJobs;
 };
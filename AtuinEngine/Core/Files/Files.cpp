@@ -2,6 +2,8 @@
 #include "Files.h"
 #include "FileManager.h"
 
+#include <filesystem>
+
 
 namespace Atuin {
     
@@ -36,19 +38,36 @@ void Files::Write(std::string_view fileName, std::string_view buffer, std::ios::
 }
 
 
-void Files::ReadAsync(void *data) const {
+JobID Files::ReadAsync(std::string_view fileName, Array<char> &buffer, Task continuation, void *data, std::ios::openmode mode, JobPriority priority) const {
 
-    auto readData = (AsyncReadData*)data;
+    if ( Ready() )
+    {
+        return sFileManager->ReadAsync(fileName, buffer, std::move(continuation), data, mode, priority);
+    }
 
-    return Read( readData->fileName, readData->buffer, readData->mode);
+    // no FileManager, so the file is read on the calling thread like FileManager does without JobManager
+    FileManager::ReadFile(std::filesystem::current_path(), fileName, buffer, mode, Log());
+    if (continuation)
+    {
+        continuation(data);
+    }
+    return -1;
 }
 
 
-void Files::WriteAsync(void *data) const {
+JobID Files::WriteAsync(std::string_view fileName, std::string buffer, Task continuation, void *data, std::ios::openmode mode, JobPriority priority) const {
 
-    auto writeData = (AsyncWriteData*)data;
+    if ( Ready() )
+    {
+        return sFileManager->WriteAsync(fileName, std::move(buffer), std::move(continuation), data, mode, priority);
+    }
 
-    Write( writeData->fileName, writeData->buffer, writeData->mode);
+    FileManager::WriteFile(std::filesystem::current_path(), fileName, buffer, mode, Log());
+    if (continuation)
+    {
+        continuation(data);
+    }
+    return -1;
 }
 
 
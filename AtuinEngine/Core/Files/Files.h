@@ -3,6 +3,8 @@
 
 
 #include "Core/DataStructures/Array.h"
+#include "Core/Jobs/Coroutine.h"
+#include "Core/Jobs/Jobs.h"
 
 #include <iostream>
 #include <string>
@@ -21,18 +23,30 @@ class Files {
 
 public:
 
-    struct AsyncReadData {
+    struct ReadAwaiter {
 
-        std::string fileName;
-        Array<char> buffer;
-        std::ios::openmode mode = std::ios::in;
-    };
+        bool await_ready() const noexcept { return false; }
+
+        // without FileManager or JobManager the file is read on the calling thread and the coroutine continues right away
+        bool await_suspend(std::coroutine_handle<> handle) const {
+
+            Files files;
+            if (!files.Ready() || !Jobs().Ready())
+            {
+                files.ReadAsync(fileName, buffer, Task(), nullptr, mode, priority);
+                return false;
+            }
+
+            files.ReadAsync(fileName, buffer, [handle](void*){ handle.resume(); }, nullptr, mode, priority);
+            return true;
+        }
 
-    struct AsyncWriteData {
+        void await_resume() const noexcept {}
 
-        std::string fileName;
-        std::string buffer;
-        std::ios::openmode mode = std::ios::out;
+        std::string_view fileName;
+        Array<char> &buffer;
+        std::ios::openmode mode;
+        JobPriority priority;
     };
 
 
@@ -45,8 +59,15 @@ public:
     void Read(std::string_view fileName, Array<char> &buffer, std::ios::openmode mode = std::ios::in) const ;
     void Write(std::string_view fileName, std::string_view buffer, std::ios::openmode mode = std::ios::out) const ;
  
-    void ReadAsync(void *data) const;
-    void WriteAsync(void *data) const;
+    // file access on an I/O thread, the continuation runs as a job afterwards, see FileManager::ReadAsync()
+    // without FileManager the file is accessed and the continuation called on the calling thread, -1 is returned
+    JobID ReadAsync(std::string_view fileName, Array<char> &buffer, Task continuation = Task(), void *data = nullptr, 
+                    std::ios::openmode mode = std::ios::in, JobPriority priority = JobPriority::NORMAL) const;
+    JobID WriteAsync(std::string_view fileName, std::string buffer, Task continuation = Task(), void *data = nullptr, 
+                     std::ios::openmode mode = std::ios::out, JobPriority priority = JobPriority::NORMAL) const;
+    // co_await in a Coroutine, it continues once the file has been read
+    ReadAwaiter AwaitRead(std::string_view fileName, Array<char> &buffer, std::ios::openmode mode = std::ios::in, 
+                          JobPriority priority = JobPriority::NORMAL) const { return ReadAwaiter{ fileName, buffer, mode, priority }; }
 
 private:
 
@@ -0,0 +1,286 @@
+#pragma once
+
+
+#include "Jobs.h"
+
+#include <cassert>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+
+namespace Atuin {
+
+
+template<typename T = void>
+class Coroutine;
+
+
+struct CoroutinePromiseBase {
+
+    struct FinalAwaiter {
+
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+
+            CoroutinePromiseBase &promise = handle.promise();
+            if (promise.continuation)
+            {
+                return promise.continuation;
+            }
+
+            // the coroutine may be destroyed as soon as this job has finished
+            JobID done = promise.done;
+            if (done >= 0)
+            {
+                Jobs().Run(done);
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+
+    // lazy, the coroutine only starts once it is started as a job or awaited
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() { exception = std::current_exception(); }
+
+    // coroutine that awaits this one, resumed on the same thread once this one has finished
+    std::coroutine_handle<> continuation;
+    // job run once this coroutine has finished, -1 if it was awaited instead of started
+    JobID done = -1;
+    std::exception_ptr exception;
+};
+
+
+template<typename T>
+struct CoroutinePromise : CoroutinePromiseBase {
+
+    void return_value(T value) { result.emplace( std::move(value)); }
+
+    T TakeResult() {
+
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+        return std::move(*result);
+    }
+
+    std::optional<T> result;
+};
+
+
+template<>
+struct CoroutinePromise<void> : CoroutinePromiseBase {
+
+    void return_void() const noexcept {}
+
+    void TakeResult() const {
+
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+
+/* @brief Coroutine returning a T, scheduled on JobManager.
+ *        Start() resumes it as a job, a coroutine awaiting another one runs it right away and continues once it has finished.
+ *        Each co_await on AwaitJob(), AwaitNextFrame() or Files::AwaitRead() suspends it without occupying a thread,
+ *        it continues on whichever worker picks up the resume job. Without JobManager it runs to completion inside Start().
+ *        Exceptions are rethrown by Get() or in the awaiting coroutine.
+ */
+template<typename T>
+class Coroutine {
+
+public:
+
+    struct promise_type : CoroutinePromise<T> {
+
+        Coroutine get_return_object() { return Coroutine( std::coroutine_handle<promise_type>::from_promise(*this) ); }
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+
+    struct Awaiter {
+
+        bool await_ready() const noexcept { return false; }
+
+        // symmetric transfer, the awaited coroutine runs on this thread without growing the stack
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+
+        T await_resume() { return handle.promise().TakeResult(); }
+
+        Handle handle;
+    };
+
+
+    Coroutine() = default;
+    Coroutine(const Coroutine&) = delete;
+    Coroutine(Coroutine &&other) noexcept : mHandle {std::exchange(other.mHandle, nullptr)}, mStarted {other.mStarted} {}
+    ~Coroutine() { Destroy(); }
+
+    Coroutine& operator= (const Coroutine&) = delete;
+    Coroutine& operator= (Coroutine &&rhs) noexcept;
+
+
+    // Runs the coroutine as a job until its first suspension.
+    void Start(JobPriority priority = JobPriority::NORMAL);
+    // Starts the coroutine if needed and waits until it has finished, inside a job only the calling fiber is suspended.
+    void Wait();
+    // Waits and returns the result, the result can only be taken once.
+    T Get();
+
+    bool IsValid() const { return (bool)mHandle; }
+
+    // only coroutines that have not been started can be awaited
+    Awaiter operator co_await() noexcept;
+
+
+private:
+
+    explicit Coroutine(Handle handle) : mHandle {handle}, mStarted {false} {}
+
+    void Destroy();
+
+
+    Handle mHandle = nullptr;
+    bool mStarted = false;
+};
+
+
+struct JobAwaiter {
+
+    bool await_ready() const noexcept { return id < 0 || !Jobs().Ready(); }
+
+    void await_suspend(std::coroutine_handle<> handle) const {
+
+        // waits on a fiber of its own, so no worker is blocked until the job has finished
+        Jobs jobs;
+        jobs.Run( jobs.CreateJob( [handle, id = id](void*){ Jobs().Wait(id); handle.resume(); }, nullptr, -1, priority ) );
+    }
+
+    void await_resume() const noexcept {}
+
+    JobID id;
+    JobPriority priority;
+};
+
+
+struct NextFrameAwaiter {
+
+    bool await_ready() const noexcept { return !Jobs().Ready(); }
+
+    void await_suspend(std::coroutine_handle<> handle) const {
+
+        Jobs jobs;
+        jobs.RunNextFrame( jobs.CreateJob( [handle](void*){ handle.resume(); }, nullptr, -1, priority ) );
+    }
+
+    void await_resume() const noexcept {}
+
+    JobPriority priority;
+};
+
+
+// continues once the job has finished
+inline JobAwaiter AwaitJob(JobID id, JobPriority priority = JobPriority::NORMAL) { return JobAwaiter{ id, priority }; }
+// continues at the start of the next frame, see JobManager::BeginFrame()
+inline NextFrameAwaiter AwaitNextFrame(JobPriority priority = JobPriority::NORMAL) { return NextFrameAwaiter{ priority }; }
+
+
+template<typename T>
+Coroutine<T>& Coroutine<T>::operator= (Coroutine &&rhs) noexcept {
+
+    if (this != &rhs)
+    {
+        Destroy();
+        mHandle = std::exchange(rhs.mHandle, nullptr);
+        mStarted = rhs.mStarted;
+    }
+
+    return *this;
+}
+
+
+template<typename T>
+void Coroutine<T>::Start(JobPriority priority) {
+
+    assert(mHandle && !mStarted);
+    mStarted = true;
+
+    Jobs jobs;
+    if (!jobs.Ready())
+    {
+        mHandle.resume();
+        return;
+    }
+
+    mHandle.promise().done = jobs.CreateJob( [](void*){}, nullptr);
+    jobs.Run( jobs.CreateJob( [handle = mHandle](void*){ handle.resume(); }, nullptr, -1, priority ) );
+}
+
+
+template<typename T>
+void Coroutine<T>::Wait() {
+
+    assert(mHandle);
+    if (!mStarted)
+    {
+        Start();
+    }
+
+    Jobs().Wait( mHandle.promise().done);
+}
+
+
+template<typename T>
+T Coroutine<T>::Get() {
+
+    Wait();
+
+    return mHandle.promise().TakeResult();
+}
+
+
+template<typename T>
+typename Coroutine<T>::Awaiter Coroutine<T>::operator co_await() noexcept {
+
+    assert(mHandle && !mStarted);
+    mStarted = true;
+
+    return Awaiter{ mHandle };
+}
+
+
+template<typename T>
+void Coroutine<T>::Destroy() {
+
+    if (!mHandle)
+    {
+        return;
+    }
+
+    // the resume jobs still reference the frame until the coroutine has finished
+    if (mStarted)
+    {
+        Wait();
+    }
+    mHandle.destroy();
+    mHandle = nullptr;
+}
+
+
+} // Atuin
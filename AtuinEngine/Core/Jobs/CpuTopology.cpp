@@ -0,0 +1,157 @@
+#include "CpuTopology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace Atuin {
+
+
+namespace {
+
+
+#ifdef __linux__
+
+// value of a topology file of a logical cpu, fallback if it can not be read
+U32 ReadTopologyValue(U32 cpu, const char *name, U32 fallback) {
+
+    std::ifstream file( "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name );
+
+    I64 value = -1;
+    if (!(file >> value) || value < 0)
+    {
+        return fallback;
+    }
+
+    return (U32)value;
+}
+
+#endif
+
+
+} // anonymous
+
+
+CpuTopology CpuTopology::Detect() {
+
+    CpuTopology topology;
+
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &cpus) == 0)
+    {
+        for (U32 cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &cpus))
+            {
+                // without topology information every cpu is its own core
+                topology.AddLogicalCpu(cpu, ReadTopologyValue(cpu, "physical_package_id", 0), ReadTopologyValue(cpu, "core_id", cpu));
+            }
+        }
+    }
+#endif
+
+    if (topology.mCores.IsEmpty())
+    {
+        U32 numCpus = std::max(std::thread::hardware_concurrency(), 1u);
+        for (U32 cpu = 0; cpu < numCpus; cpu++)
+        {
+            topology.AddLogicalCpu(cpu, 0, cpu);
+        }
+    }
+
+    return topology;
+}
+
+
+Size CpuTopology::NumLogicalCpus() const {
+
+    Size numCpus = 0;
+    for (const PhysicalCore &core : mCores)
+    {
+        numCpus += core.logicalCpus.GetSize();
+    }
+
+    return numCpus;
+}
+
+
+Array<U32> CpuTopology::PinOrder() const {
+
+    Array<U32> order( NumLogicalCpus());
+
+    // first hardware thread of every core, then the second one of every core and so on
+    for (Size thread = 0; order.GetSize() < order.GetCapacity(); thread++)
+    {
+        for (const PhysicalCore &core : mCores)
+        {
+            if (thread < core.logicalCpus.GetSize())
+            {
+                order.PushBack( core.logicalCpus[thread]);
+            }
+        }
+    }
+
+    return order;
+}
+
+
+bool CpuTopology::PinCurrentThread(U32 logicalCpu) {
+
+#ifdef __linux__
+    if (logicalCpu >= CPU_SETSIZE)
+    {
+        return false;
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(logicalCpu, &cpus);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus) == 0;
+#else
+    (void)logicalCpu;
+    return false;
+#endif
+}
+
+
+void CpuTopology::SetCurrentThreadName(std::string_view name) {
+
+#ifdef __linux__
+    // 16 bytes including the terminating zero
+    std::string truncated( name.substr(0, 15) );
+    pthread_setname_np(pthread_self(), truncated.c_str());
+#else
+    (void)name;
+#endif
+}
+
+
+void CpuTopology::AddLogicalCpu(U32 cpu, U32 package, U32 core) {
+
+    for (PhysicalCore &physicalCore : mCores)
+    {
+        if (physicalCore.package == package && physicalCore.core == core)
+        {
+            physicalCore.logicalCpus.PushBack(cpu);
+            return;
+        }
+    }
+
+    PhysicalCore &physicalCore = mCores.EmplaceBack();
+    physicalCore.package = package;
+    physicalCore.core = core;
+    physicalCore.logicalCpus.PushBack(cpu);
+}
+
+
+} // Atuin
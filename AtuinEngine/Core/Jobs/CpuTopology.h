@@ -0,0 +1,54 @@
+#pragma once
+
+
+#include "Core/Util/Types.h"
+#include "Core/DataStructures/Array.h"
+
+#include <string_view>
+
+
+namespace Atuin {
+
+
+struct PhysicalCore {
+
+    U32 package = 0;
+    U32 core = 0;
+    // hardware threads of this core, more than one with SMT
+    Array<U32> logicalCpus;
+};
+
+
+/* @brief Physical cores and their hardware threads that this process may run on.
+ *        On Linux the cores are read from /sys/devices/system/cpu and limited to the affinity mask of the process,
+ *        elsewhere or if that fails every hardware thread is treated as its own core.
+ */
+class CpuTopology {
+
+public:
+
+    static CpuTopology Detect();
+
+    Size NumLogicalCpus() const;
+    Size NumPhysicalCores() const { return mCores.GetSize(); }
+    const Array<PhysicalCore>& Cores() const { return mCores; }
+
+    // Logical cpus to pin threads to in order, the first NumPhysicalCores() are on different cores and SMT siblings follow.
+    Array<U32> PinOrder() const;
+
+    // false if the platform does not support pinning or the cpu is not available
+    static bool PinCurrentThread(U32 logicalCpu);
+    // shown by debuggers and profilers, Linux truncates it to 15 characters
+    static void SetCurrentThreadName(std::string_view name);
+
+
+private:
+
+    void AddLogicalCpu(U32 cpu, U32 package, U32 core);
+
+
+    Array<PhysicalCore> mCores;
+};
+
+
+} // Atuin
@@ -0,0 +1,68 @@
+
+#include "Fiber.h"
+#include "Core/Memory/PageMemory.h"
+
+#include <cassert>
+#include <new>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+namespace Atuin {
+
+
+Fiber::Fiber() : mContext(), pStack {nullptr}, mStackSize {0}, mEntry {nullptr}, pArg {nullptr} {
+
+}
+
+
+Fiber::Fiber(Size stackSize, EntryPoint entry, void *arg) : mContext(), pStack {nullptr}, mStackSize {0}, mEntry {entry}, pArg {arg} {
+
+    assert(entry != nullptr);
+
+    // whole pages plus one guard page below the stack
+    Size pageSize = (Size)sysconf(_SC_PAGESIZE);
+    mStackSize = ((stackSize + pageSize - 1) / pageSize + 1) * pageSize;
+
+    pStack = PageMemory::Map(mStackSize, PageBacking{PageType::MMAP, false});
+    if (pStack == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    mprotect(pStack, pageSize, PROT_NONE);
+
+    getcontext(&mContext);
+    mContext.uc_stack.ss_sp = pStack;
+    mContext.uc_stack.ss_size = mStackSize;
+    mContext.uc_link = nullptr;
+
+    // makecontext only passes int arguments, split the pointer in two halves
+    UPtr self = reinterpret_cast<UPtr>(this);
+    makecontext(&mContext, reinterpret_cast<void(*)()>(&Fiber::Start), 2, (U32)(self >> 32), (U32)(self & 0xFFFFFFFF));
+}
+
+
+Fiber::~Fiber() {
+
+    PageMemory::Unmap(pStack, mStackSize, PageBacking{PageType::MMAP, false});
+}
+
+
+void Fiber::SwitchTo(Fiber &next) {
+
+    swapcontext(&mContext, &next.mContext);
+}
+
+
+void Fiber::Start(U32 fiberHigh, U32 fiberLow) {
+
+    Fiber *fiber = reinterpret_cast<Fiber*>( (UPtr)fiberHigh << 32 | (UPtr)fiberLow );
+    fiber->mEntry(fiber->pArg);
+
+    // there is no context to return to
+    assert(false);
+}
+
+
+} // Atuin
@@ -0,0 +1,55 @@
+#pragma once
+
+
+#include "Core/Util/Types.h"
+
+#include <ucontext.h>
+
+
+namespace Atuin {
+
+
+/* @brief Execution context with its own stack that is switched to cooperatively.
+ *        A default constructed fiber has no stack and stands for the thread it is used on,
+ *        SwitchTo() saves the running context into it, so that another fiber can switch back to the thread later.
+ *        Stacks are mapped pages with an inaccessible guard page at the bottom, so an overflow faults instead of corrupting memory.
+ */
+class Fiber {
+
+public:
+
+    using EntryPoint = void(*)(void*);
+
+
+    Fiber();
+    // entry must never return, switch to another fiber instead
+    Fiber(Size stackSize, EntryPoint entry, void *arg);
+    ~Fiber();
+
+    // the saved context points into this object
+    Fiber(const Fiber&) = delete;
+    Fiber& operator= (const Fiber&) = delete;
+
+
+    // Saves the calling context into this fiber and continues next. Returns once some fiber switches back to this one.
+    void SwitchTo(Fiber &next);
+
+    Size StackSize() const { return mStackSize; }
+
+
+private:
+
+    static void Start(U32 fiberHigh, U32 fiberLow);
+
+
+    ucontext_t mContext;
+
+    void *pStack;
+    Size mStackSize;
+
+    EntryPoint mEntry;
+    void *pArg;
+};
+
+
+} // Atuin
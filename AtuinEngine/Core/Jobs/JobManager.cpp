@@ -4,34 +4,83 @@
 #include "EngineLoop.h"
 #include "Core/Config/ConfigManager.h"
 #include "Core/Debug/Logger.h"
+#include "Core/Util/StringFormat.h"
 
 
 namespace Atuin {
  
 
-// CVar<U8>* JobManager::pMaxFibersOnThread = ConfigManager::RegisterCVar("Multithreading", "MAX_FIBERS_ON_THREAD", (U8)16);
+CVar<U8>* JobManager::pMaxFibersOnThread = ConfigManager::RegisterCVar("Multithreading", "MAX_FIBERS_ON_THREAD", (U8)16);
+CVar<Size>* JobManager::pFiberStackSize = ConfigManager::RegisterCVar("Multithreading", "FIBER_STACK_SIZE", 256_KB);
 CVar<Size>* JobManager::pMaxJobsPerFrame = ConfigManager::RegisterCVar("Multithreading", "MAX_JOBS_PER_FRAME", (Size)4096);
+CVar<U32>* JobManager::pWorkerSpinCount = ConfigManager::RegisterCVar("Multithreading", "WORKER_SPIN_COUNT", (U32)1024);
+CVar<Size>* JobManager::pBackgroundJobThreads = ConfigManager::RegisterCVar("Multithreading", "BACKGROUND_JOB_THREADS", (Size)1);
+CVar<U32>* JobManager::pNumWorkerThreads = ConfigManager::RegisterCVar("Multithreading", "NUM_WORKER_THREADS", 0U);
+CVar<bool>* JobManager::pPinThreads = ConfigManager::RegisterCVar("Multithreading", "PIN_THREADS", false);
+CVar<Size>* JobManager::pJobTraceEvents = ConfigManager::RegisterCVar("Multithreading", "JOB_TRACE_EVENTS", (Size)16384);
 
 
-thread_local Size JobManager::sThreadID = 0;
+thread_local Size JobManager::sThreadID = JobManager::EXTERNAL_THREAD;
+
+
+namespace {
+
+
+// tells the core that this is a spin wait loop, so that it does not starve its hyperthread sibling
+void CpuRelax() {
+
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+
+} // anonymous
 
 
 JobManager::JobManager(Size numThreads) : 
     mActive {false},
-    mNumJobs {0}, 
     mJobs( pMaxJobsPerFrame->Get()), 
+    mFreeSlots {0},
+    mNextFreeSlots( pMaxJobsPerFrame->Get()),
+    mJobPriorities( pMaxJobsPerFrame->Get(), JobPriority::NORMAL),
+    mTopology( CpuTopology::Detect()),
+    mPinOrder(),
     mNumThreads {numThreads}, 
     mThreads(),
     mJobQueues(), 
-    mLog()
+    mNextFrameJobs(),
+    mNextFrameLock(),
+    mExternalQueues(),
+    mNumBackgroundJobs {0},
+    mFiberThreads(),
+    mWaitingFibers( pMaxJobsPerFrame->Get()),
+    mNumParked {0},
+    mTracer(),
+    mLog(),
+    mMemory()
 {
-    // allocate thread and job queue arrays
+    // SMT siblings share execution units, so by default only one worker runs per physical core
+    if (mNumThreads == 0)
+    {
+        mNumThreads = pNumWorkerThreads->Get();
+    }
     if (mNumThreads == 0)
     {
-        mNumThreads = std::max(std::thread::hardware_concurrency(), 2u) - 1u;
+        mNumThreads = std::max(mTopology.NumPhysicalCores(), (Size)2) - 1;
     }
+    mPinOrder = mTopology.PinOrder();
+
+    // allocate thread and job queue arrays
     mThreads.Reserve(mNumThreads);
-    mJobQueues.Reserve(mNumThreads + 1);
+    mJobQueues.Reserve( (Size)JobPriority::COUNT * (mNumThreads + 1) );
+    mFiberThreads = Array<FiberThread>(mNumThreads + 1);
+
+    mExternalQueues = Array<ExternalQueue>( (Size)JobPriority::COUNT );
+    for (Size i = 0; i < (Size)JobPriority::COUNT; i++)
+    {
+        mExternalQueues.EmplaceBack();
+    }
 }
 
 
@@ -42,22 +91,45 @@ JobManager::~JobManager() {
 
 void JobManager::StartUp() {
 
-    // create empty jobs in job array
+    // create empty jobs in job array, lowest slots are handed out first
     for (Size i = 0; i < mJobs.GetCapacity(); i++)
     {
         mJobs.EmplaceBack();
+        mNextFreeSlots.EmplaceBack(0u);
+        mWaitingFibers.EmplaceBack(nullptr);
+    }
+    for (Size i = mJobs.GetSize(); i > 0; i--)
+    {
+        ReleaseSlot(i - 1);
     }
 
     // create job queues
-    for (Size i = 0; i <= mNumThreads; i++)
+    for (Size i = 0; i < mJobQueues.GetCapacity(); i++)
     {
         mJobQueues.EmplaceBack( pMaxJobsPerFrame->Get() );
     }
 
-    // create worker threads
+    // trace buffers are only written once StartTrace() is called
+    if (pJobTraceEvents->Get() > 0)
+    {
+        mTracer.Init(mNumThreads + 1, pJobTraceEvents->Get());
+    }
+
+    // create fiber pools, stack pages are only committed once they are touched
     mActive.store(true);
     try
     {
+        for (Size i = 0; i <= mNumThreads; i++)
+        {
+            FiberThread &thread = mFiberThreads.EmplaceBack();
+            for (U8 j = 0; j < pMaxFibersOnThread->Get(); j++)
+            {
+                thread.fibers.PushBack( mMemory.New<JobFiber>(this, i) );
+                thread.freeFibers.PushBack( thread.fibers.Back() );
+            }
+        }
+
+        // create worker threads
         for (Size i = 0; i < mNumThreads; i++)
         {
             mThreads.EmplaceBack(&JobManager::WorkerThread, this, i);
@@ -65,12 +137,18 @@ void JobManager::StartUp() {
     }
     catch(const std::exception& e)
     {
+        // only the fiber pools and threads created so far are torn down, the manager is never published
         ShutDown();
         mLog.Error(LogChannel::GENERAL, e.what());
+        return;
     }
 
     // main thread has the last queue in the array
     sThreadID = mNumThreads;
+    SetUpThread(mNumThreads);
+
+    mLog.Info(LogChannel::GENERAL, FormatStr("Started %d worker threads on %d physical cores with %d hardware threads.", 
+        (int)mNumThreads, (int)mTopology.NumPhysicalCores(), (int)mTopology.NumLogicalCpus()));
 
     Jobs::sJobManager = this;
 }
@@ -78,121 +156,829 @@ void JobManager::StartUp() {
 
 void JobManager::ShutDown() {
 
+    if (Jobs::sJobManager == this)
+    {
+        Jobs::sJobManager = nullptr;
+    }
+
+    // workers that are about to park see mActive cleared, all others are woken here
+    // a failed StartUp() may have created fewer fiber threads and workers than mNumThreads
     mActive.store(false);
-    mJobsReadyCV.notify_all();
-    for (Size i = 0; i < mNumThreads; i++)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (Size i = 0; i < mFiberThreads.GetSize(); i++)
+    {
+        Wake(mFiberThreads[i]);
+    }
+
+    for (Size i = 0; i < mThreads.GetSize(); i++)
     {
         if (mThreads[i].joinable())
         {
             mThreads[i].join();
         }
     }    
+
+    for (Size i = 0; i < mFiberThreads.GetSize(); i++)
+    {
+        for (Size j = 0; j < mFiberThreads[i].fibers.GetSize(); j++)
+        {
+            mMemory.Delete(mFiberThreads[i].fibers[j]);
+        }
+        mFiberThreads[i].fibers.Clear();
+        mFiberThreads[i].freeFibers.Clear();
+        mFiberThreads[i].readyFibers.Clear();
+    }
+
+    // the calling thread is no longer owned, a later JobManager must not route it to this one's queues and fibers
+    sThreadID = EXTERNAL_THREAD;
 }
 
 
 void JobManager::WorkerThread(Size threadID) {
 
     sThreadID = threadID;
+    SetUpThread(threadID);
+
+    Schedule(mFiberThreads[threadID]);
+}
+
+
+void JobManager::SetUpThread(Size threadID) {
+
+    CpuTopology::SetCurrentThreadName( threadID == mNumThreads ? std::string("Atuin Main") : FormatStr("Atuin Worker %d", (int)threadID) );
+
+    // pinned threads are not migrated by the OS, the main thread gets the first core
+    if (pPinThreads->Get() && !mPinOrder.IsEmpty())
+    {
+        U32 cpu = mPinOrder[ (threadID + 1) % (mNumThreads + 1) % mPinOrder.GetSize() ];
+        if (!CpuTopology::PinCurrentThread(cpu))
+        {
+            mLog.Warning(LogChannel::GENERAL, FormatStr("Could not pin thread %d to cpu %d.", (int)threadID, (int)cpu));
+        }
+    }
+}
+
+
+void JobManager::Schedule(FiberThread &thread) {
+
+    while (!IsSchedulerDone(thread))
+    {
+        // fibers that can continue after a wait go first, they hold up the jobs waiting on them
+        JobFiber *fiber = PopReadyFiber(thread);
+        if (fiber == nullptr)
+        {
+            fiber = AcquireFiber(thread);
+        }
+
+        // memory tag scopes opened by a job stay with its fiber while other fibers run on this thread
+        MemoryTag schedulerTag = MemoryTagScope::Current();
+        MemoryTagScope::SetCurrent(fiber->memoryTag);
+
+        thread.current = fiber;
+        thread.idle = false;
+        thread.scheduler.SwitchTo(fiber->fiber);
+        thread.current = nullptr;
+
+        fiber->memoryTag = MemoryTagScope::Current();
+        MemoryTagScope::SetCurrent(schedulerTag);
+
+        // the fiber is off its stack now, so whichever thread finishes the awaited job may hand it back to this thread
+        if (thread.pendingWait >= 0)
+        {
+            JobID id = thread.pendingWait;
+            thread.pendingWait = -1;
+            ParkFiber(fiber, id);
+            continue;
+        }
+
+        thread.freeFibers.PushBack(fiber);
+
+        if (thread.idle && thread.numReady.load(std::memory_order_relaxed) == 0)
+        {
+            if (thread.waitFor >= 0)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                U64 idleBegin = mTracer.IsEnabled() ? mTracer.Now() : 0;
+                Park(thread);
+                if (mTracer.IsEnabled())
+                {
+                    mTracer.Record(sThreadID, TraceEvent{ idleBegin, mTracer.Now(), -1, 0, TraceEventType::IDLE });
+                }
+            }
+        }
+    }
+}
+
+
+void JobManager::Park(FiberThread &thread) {
+
+    // short bursts of jobs usually arrive within a few microseconds, spinning avoids the syscalls of sleeping and waking
+    for (U32 i = 0; i < pWorkerSpinCount->Get(); i++)
+    {
+        if (HasWork(thread))
+        {
+            return;
+        }
+        CpuRelax();
+    }
+
+    thread.parkState.store(PARKED, std::memory_order_relaxed);
+    mNumParked.fetch_add(1, std::memory_order_relaxed);
+
+    // pairs with the fence in Run(), ReadyFiber() and ShutDown(): either they see this worker parked or it sees their work
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (HasWork(thread))
+    {
+        // nobody has woken this worker yet -> take the park back, otherwise the waking thread already did
+        U32 parked = PARKED;
+        if (thread.parkState.compare_exchange_strong(parked, RUNNING, std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+            mNumParked.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    while (thread.parkState.load(std::memory_order_acquire) == PARKED)
+    {
+        thread.parkState.wait(PARKED, std::memory_order_acquire);
+    }
+}
+
+
+bool JobManager::HasWork(FiberThread &thread) {
+
+    if (thread.numReady.load(std::memory_order_relaxed) > 0 || !mActive.load(std::memory_order_relaxed))
+    {
+        return true;
+    }
+
+    // queued background jobs do not count while the background threads are all busy, see ReleaseBackgroundJobs()
+    bool background = sThreadID < mNumThreads && mNumBackgroundJobs.load(std::memory_order_relaxed) < MaxBackgroundJobs();
+    Size numQueues = (background ? (Size)JobPriority::COUNT : (Size)JobPriority::BACKGROUND) * (mNumThreads + 1);
+
+    for (Size i = 0; i < numQueues; i++)
+    {
+        if (!mJobQueues[i].IsEmpty())
+        {
+            return true;
+        }
+    }
+
+    for (Size i = 0; i < numQueues / (mNumThreads + 1); i++)
+    {
+        if (mExternalQueues[i].size.load(std::memory_order_relaxed) > 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool JobManager::Wake(FiberThread &thread) {
+
+    U32 parked = PARKED;
+    if (!thread.parkState.compare_exchange_strong(parked, RUNNING, std::memory_order_acq_rel, std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    mNumParked.fetch_sub(1, std::memory_order_relaxed);
+    thread.parkState.notify_one();
+
+    return true;
+}
 
-    // when using fibers
-    // also wrap below code in a fiber and detach, mFibersPerThread - 1 times
 
-    JobID jobId = -1;
-    while (mActive.load(std::memory_order_relaxed))
+void JobManager::WakeOne() {
+
+    // start next to the calling thread, so that concurrent callers tend to wake different workers
+    Size self = IsExternalThread() ? mNumThreads : sThreadID;
+    Size numOthers = IsExternalThread() ? mNumThreads + 1 : mNumThreads;
+    for (Size i = 1; i <= numOthers; i++)
     {
-        jobId = GetJob();
+        if (Wake( mFiberThreads[ (self + i) % (mNumThreads + 1) ] ))
+        {
+            return;
+        }
+    }
+}
+
+
+bool JobManager::IsSchedulerDone(FiberThread &thread) {
+
+    return thread.waitFor >= 0 ? IsFinished(thread.waitFor) : !mActive.load(std::memory_order_relaxed);
+}
+
+
+void JobManager::SwitchToScheduler(FiberThread &thread) {
+
+    thread.current->fiber.SwitchTo(thread.scheduler);
+}
+
+
+void JobManager::FiberMain(void *manager) {
+
+    JobManager *jobManager = static_cast<JobManager*>(manager);
+
+    // fibers never return, the scheduler switches back into this loop
+    while (true)
+    {
+        FiberThread &thread = jobManager->mFiberThreads[sThreadID];
+
+        JobID jobId = jobManager->GetJob();
         if (jobId >= 0)
         {
-            ExecuteJob(jobId);
+            jobManager->ExecuteJob(jobId);
         }
-        else
+
+        // stay on this fiber as long as there is nothing else for the scheduler to do
+        thread.idle = jobId < 0;
+        if (thread.idle || thread.numReady.load(std::memory_order_relaxed) > 0 || jobManager->IsSchedulerDone(thread))
+        {
+            jobManager->SwitchToScheduler(thread);
+        }
+    }
+}
+
+
+JobManager::JobFiber* JobManager::AcquireFiber(FiberThread &thread) {
+
+    if (thread.freeFibers.IsEmpty())
+    {
+        // all fibers of this thread are waiting, a new one is cheaper than risking a deadlock in deep job graphs
+        mLog.Warning(LogChannel::GENERAL, "All fibers of a thread are waiting, increase MAX_FIBERS_ON_THREAD.");
+        thread.fibers.PushBack( mMemory.New<JobFiber>(this, sThreadID) );
+        return thread.fibers.Back();
+    }
+
+    JobFiber *fiber = thread.freeFibers.Back();
+    thread.freeFibers.PopBack();
+
+    return fiber;
+}
+
+
+JobManager::JobFiber* JobManager::PopReadyFiber(FiberThread &thread) {
+
+    if (thread.numReady.load(std::memory_order_relaxed) == 0)
+    {
+        return nullptr;
+    }
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( thread.readyLock);
+
+    JobFiber *fiber = thread.readyFibers.Back();
+    thread.readyFibers.PopBack();
+    thread.numReady.fetch_sub(1, std::memory_order_relaxed);
+
+    return fiber;
+}
+
+
+void JobManager::ParkFiber(JobFiber *fiber, JobID id) {
+
+    Size index = SlotIndex(id);
+    Job &job = mJobs[index];
+
+    {
+        // lock mutex
+        const std::lock_guard<std::mutex> lock( mWaitLock);
+
+        // counterpart to FinishJob(), either the last decrement sees the flag or this sees the job finished
+        U32 count = job.unfinishedCount.fetch_or(WAITER_FLAG, std::memory_order_acq_rel);
+
+        // the flag might have ended up on a job that reuses the slot, that only costs it an empty ResumeWaiters()
+        if ((count & ~WAITER_FLAG) != 0 && job.generation.load(std::memory_order_acquire) == Generation(id))
         {
-            std::unique_lock<std::mutex> lock(mJobsReadyLock);
-            mJobsReadyCV.wait(lock);
+            fiber->nextWaiting = mWaitingFibers[index];
+            mWaitingFibers[index] = fiber;
+            return;
         }
     }
+
+    // finished in the meantime
+    ReadyFiber(fiber);
 }
 
 
-JobID JobManager::CreateJob(Task task, void *jobData, JobID parent) {
+void JobManager::ResumeWaiters(Size index) {
 
-    JobID id = Math::ModuloPowerOfTwo( mNumJobs.fetch_add(1, std::memory_order_relaxed) , mJobs.GetCapacity());
+    JobFiber *fiber;
+    {
+        // lock mutex
+        const std::lock_guard<std::mutex> lock( mWaitLock);
 
-    mJobs[id].task = task;
-    mJobs[id].data = jobData;
-    mJobs[id].parent = parent;
-    mJobs[id].unfinishedCount.store(1, std::memory_order_relaxed);
+        fiber = mWaitingFibers[index];
+        mWaitingFibers[index] = nullptr;
+    }
+
+    while (fiber != nullptr)
+    {
+        JobFiber *next = fiber->nextWaiting;
+        fiber->nextWaiting = nullptr;
+        ReadyFiber(fiber);
+        fiber = next;
+    }
+}
+
+
+void JobManager::ReadyFiber(JobFiber *fiber) {
+
+    FiberThread &thread = mFiberThreads[fiber->threadID];
+    {
+        // lock mutex
+        const std::lock_guard<std::mutex> lock( thread.readyLock);
+        thread.readyFibers.PushBack(fiber);
+        thread.numReady.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // the owning thread might be about to park, see Park()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    Wake(thread);
+}
+
+
+JobID JobManager::CreateJob(Task task, void *jobData, JobID parent, JobPriority priority) {
+
+    Size index;
+    while (!AcquireSlot(index))
+    {
+        // all slots are in flight -> help finishing jobs instead of overwriting a live one
+        JobID jobId = IsExternalThread() ? -1 : GetJob();
+        if (jobId >= 0)
+        {
+            ExecuteJob(jobId);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    Job &job = mJobs[index];
+    job.task = std::move(task);
+    job.data = jobData;
+    job.parent = parent;
+    mJobPriorities[index] = priority;
+    // release, so that ParkFiber() sees the new generation once it sees this count
+    job.unfinishedCount.store(1, std::memory_order_release);
 
     if (parent >= 0) 
     {
-        mJobs[parent].unfinishedCount.fetch_add(1, std::memory_order_relaxed);
+        assert(!IsFinished(parent));
+        mJobs[SlotIndex(parent)].unfinishedCount.fetch_add(1, std::memory_order_relaxed);
     }
 
-    return id;
+    return MakeJobID(index, job.generation.load(std::memory_order_relaxed));
 }
 
 
 void JobManager::Run(JobID id) {
 
-    mJobQueues[sThreadID].Push(id);
-    mJobsReadyCV.notify_all();
+    if (IsExternalThread())
+    {
+        RunExternal(id);
+        return;
+    }
+
+    // queue can not grow any further -> do the work right away instead of dropping the job
+    if (!JobQueue(sThreadID, mJobPriorities[SlotIndex(id)]).Push(id))
+    {
+        mLog.Warning(LogChannel::GENERAL, "Job queue is full, executing job on the calling thread.");
+        if (mJobPriorities[SlotIndex(id)] == JobPriority::BACKGROUND)
+        {
+            // ExecuteJob() gives back the background slot GetJob() would have taken
+            mNumBackgroundJobs.fetch_add(1, std::memory_order_relaxed);
+        }
+        ExecuteJob(id);
+        return;
+    }
+
+    // one job needs at most one more worker, only look for a parked one if there is any
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mNumParked.load(std::memory_order_relaxed) > 0)
+    {
+        WakeOne();
+    }
 }
 
 
 void JobManager::Wait(JobID id) {
 
-    while (!IsFinished(id))
+    if (IsFinished(id))
     {
-        JobID jobId = GetJob();
-        if (jobId >= 0)
+        return;
+    }
+
+    // no fibers to run jobs on
+    if (IsExternalThread())
+    {
+        while (!IsFinished(id))
         {
-            ExecuteJob(jobId);
+            std::this_thread::yield();
+        }
+        return;
+    }
+
+    FiberThread &thread = mFiberThreads[sThreadID];
+
+    // inside a job -> suspend the fiber, the scheduler parks it on the job once it is off the fiber stack
+    if (thread.current != nullptr)
+    {
+        // a suspended background job must not hold back other background jobs, it might be waiting on one of them
+        Size numBackgroundJobs = thread.current->numBackgroundJobs;
+        if (numBackgroundJobs > 0)
+        {
+            ReleaseBackgroundJobs(numBackgroundJobs);
         }
+
+        // the trace shows the job in two segments, other jobs run on this thread in between
+        JobFiber *fiber = thread.current;
+        if (mTracer.IsEnabled() && fiber->traceJob >= 0)
+        {
+            mTracer.Record(sThreadID, TraceEvent{ fiber->traceBegin, mTracer.Now(), fiber->traceJob, (U32)mJobPriorities[SlotIndex(fiber->traceJob)], TraceEventType::JOB });
+        }
+
+        thread.pendingWait = id;
+        SwitchToScheduler(thread);
+        assert(IsFinished(id));
+
+        if (mTracer.IsEnabled() && fiber->traceJob >= 0)
+        {
+            fiber->traceBegin = mTracer.Now();
+        }
+
+        mNumBackgroundJobs.fetch_add(numBackgroundJobs, std::memory_order_relaxed);
+        return;
+    }
+
+    // outside of a job -> run jobs on this thread's fibers until the job has finished
+    JobID previousWaitFor = thread.waitFor;
+    thread.waitFor = id;
+    Schedule(thread);
+    thread.waitFor = previousWaitFor;
+}
+
+
+void JobManager::StartTrace() {
+
+    if (pJobTraceEvents->Get() == 0)
+    {
+        mLog.Warning(LogChannel::GENERAL, "Job tracing is disabled, set JOB_TRACE_EVENTS to record events.");
+        return;
+    }
+
+    mTracer.Clear();
+    mTracer.SetEnabled(true);
+}
+
+
+void JobManager::StopTrace() {
+
+    mTracer.SetEnabled(false);
+}
+
+
+std::string JobManager::ExportTrace() const {
+
+    // same names as SetUpThread() gives the threads
+    Array<std::string> threadNames(mNumThreads + 1);
+    for (Size i = 0; i < mNumThreads; i++)
+    {
+        threadNames.EmplaceBack( FormatStr("Atuin Worker %d", (int)i) );
+    }
+    threadNames.EmplaceBack("Atuin Main");
+
+    return mTracer.ExportChromeJson(threadNames);
+}
+
+
+void JobManager::RunNextFrame(JobID id) {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock(mNextFrameLock);
+    mNextFrameJobs.PushBack(id);
+}
+
+
+void JobManager::BeginFrame() {
+
+    // jobs queued while these run wait for the frame after
+    Array<JobID> jobs;
+    {
+        // lock mutex
+        const std::lock_guard<std::mutex> lock(mNextFrameLock);
+        std::swap(jobs, mNextFrameJobs);
+    }
+
+    for (JobID id : jobs)
+    {
+        Run(id);
     }
 }
 
 
+void JobManager::ParallelRange(Size begin, Size end, const std::function<void(Size, Size)> &fn, Size grainSize, JobPriority priority) {
+
+    if (begin >= end)
+    {
+        return;
+    }
+
+    // a few subranges per thread, so that threads that finish early can steal the remainder
+    if (grainSize == 0)
+    {
+        grainSize = std::max( (end - begin) / (8 * NumThreads()), (Size)1 );
+    }
+
+    if (end - begin <= grainSize)
+    {
+        fn(begin, end);
+        return;
+    }
+
+    // all subrange jobs are children of root, so waiting on root waits for the whole range
+    ParallelRangeData range{ &fn, grainSize, priority, -1 };
+    range.root = CreateJob( [this, &range, begin, end](void*){ SplitRange(&range, begin, end); }, nullptr, -1, priority);
+    Run(range.root);
+    Wait(range.root);
+}
+
+
+void JobManager::SplitRange(ParallelRangeData *range, Size begin, Size end) {
+
+    // hand off the upper half until the rest is small enough to process on this thread
+    while (end - begin > range->grainSize)
+    {
+        Size mid = begin + (end - begin) / 2;
+
+        JobID half = CreateJob( [this, range, mid, end](void*){ SplitRange(range, mid, end); }, nullptr, range->root, range->priority);
+        Run(half);
+
+        end = mid;
+    }
+
+    (*range->fn)(begin, end);
+}
+
+
 JobID JobManager::GetJob() {
 
+    // all queues of a higher priority are drained before a lower one is looked at
+    JobID id = GetJob(JobPriority::HIGH);
+    if (id >= 0)
+    {
+        return id;
+    }
+
+    id = GetJob(JobPriority::NORMAL);
+    if (id >= 0 || !CanRunBackgroundJob())
+    {
+        return id;
+    }
+
+    id = GetJob(JobPriority::BACKGROUND);
+    if (id < 0)
+    {
+        mNumBackgroundJobs.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    return id;
+}
+
+
+JobID JobManager::GetJob(JobPriority priority) {
+
     JobID id;
 
-    if (mJobQueues[sThreadID].Pop(id))
+    if (JobQueue(sThreadID, priority).Pop(id))
     {
         return id;
     }
 
     for (Size i = 1; i<=mNumThreads; i++)
     {
-        if (mJobQueues[ (sThreadID + i) % (mNumThreads + 1) ].Steal(id))
+        Size victim = (sThreadID + i) % (mNumThreads + 1);
+        if (JobQueue(victim, priority).Steal(id))
         {
+            if (mTracer.IsEnabled())
+            {
+                U64 now = mTracer.Now();
+                mTracer.Record(sThreadID, TraceEvent{ now, now, id, (U32)victim, TraceEventType::STEAL });
+            }
             return id;
         }
     }
     
-    return -1;
+    return PopExternalJob(priority);
+}
+
+
+void JobManager::RunExternal(JobID id) {
+
+    ExternalQueue &queue = mExternalQueues[ (Size)mJobPriorities[SlotIndex(id)] ];
+    {
+        // lock mutex
+        const std::lock_guard<std::mutex> lock(queue.lock);
+        queue.jobs.Push(id);
+        queue.size.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // same handshake with Park() as in Run()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mNumParked.load(std::memory_order_relaxed) > 0)
+    {
+        WakeOne();
+    }
+}
+
+
+JobID JobManager::PopExternalJob(JobPriority priority) {
+
+    ExternalQueue &queue = mExternalQueues[(Size)priority];
+    if (queue.size.load(std::memory_order_relaxed) == 0)
+    {
+        return -1;
+    }
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock(queue.lock);
+    if (queue.jobs.IsEmpty())
+    {
+        return -1;
+    }
+
+    JobID id = queue.jobs.Front();
+    queue.jobs.Pop();
+    queue.size.fetch_sub(1, std::memory_order_relaxed);
+
+    return id;
+}
+
+
+bool JobManager::CanRunBackgroundJob() {
+
+    // the main thread only waits for frame work, it must not get stuck in a long background job
+    if (sThreadID == mNumThreads)
+    {
+        return false;
+    }
+
+    Size numJobs = mNumBackgroundJobs.load(std::memory_order_relaxed);
+    do
+    {
+        if (numJobs >= MaxBackgroundJobs())
+        {
+            return false;
+        }
+    }
+    while (!mNumBackgroundJobs.compare_exchange_weak(numJobs, numJobs + 1, std::memory_order_relaxed));
+
+    return true;
 }
 
 
 void JobManager::ExecuteJob(JobID id) {
 
-    mJobs[id].task(mJobs[id].data);
+    Job &job = mJobs[SlotIndex(id)];
+    bool background = mJobPriorities[SlotIndex(id)] == JobPriority::BACKGROUND;
+
+    // fibers stay on their thread, so this is the same fiber after the job returns
+    JobFiber *fiber = mFiberThreads[sThreadID].current;
+    if (background && fiber != nullptr)
+    {
+        fiber->numBackgroundJobs++;
+    }
+
+    // the fiber remembers the job, so that Wait() can split its trace, nested jobs executed while helping in CreateJob() are restored afterwards
+    bool trace = mTracer.IsEnabled() && fiber != nullptr;
+    JobID outerJob = -1;
+    U64 outerBegin = 0;
+    if (trace)
+    {
+        outerJob = fiber->traceJob;
+        outerBegin = fiber->traceBegin;
+        fiber->traceJob = id;
+        fiber->traceBegin = mTracer.Now();
+    }
+
+    job.task(job.data);
+
+    if (trace)
+    {
+        mTracer.Record(sThreadID, TraceEvent{ fiber->traceBegin, mTracer.Now(), id, (U32)mJobPriorities[SlotIndex(id)], TraceEventType::JOB });
+        fiber->traceJob = outerJob;
+        fiber->traceBegin = outerBegin;
+    }
+
     FinishJob(id);
+
+    if (background)
+    {
+        if (fiber != nullptr)
+        {
+            fiber->numBackgroundJobs--;
+        }
+        ReleaseBackgroundJobs(1);
+    }
+}
+
+
+void JobManager::ReleaseBackgroundJobs(Size count) {
+
+    mNumBackgroundJobs.fetch_sub(count, std::memory_order_relaxed);
+
+    // a parked worker might have skipped queued background jobs because all background threads were busy
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mNumParked.load(std::memory_order_relaxed) > 0)
+    {
+        WakeOne();
+    }
 }
 
 
 void JobManager::FinishJob(JobID id) {
 
-    U32 count = mJobs[id].unfinishedCount.fetch_sub(1, std::memory_order_relaxed);
-    if (count == 1 && mJobs[id].parent >= 0)
-    {      
-        FinishJob(mJobs[id].parent);
+    Size index = SlotIndex(id);
+    assert(mJobs[index].generation.load(std::memory_order_relaxed) == Generation(id));
+
+    U32 count = mJobs[index].unfinishedCount.fetch_sub(1, std::memory_order_acq_rel);
+    if ((count & ~WAITER_FLAG) == 1)
+    {
+        JobID parent = mJobs[index].parent;
+        if ((count & WAITER_FLAG) != 0)
+        {
+            ResumeWaiters(index);
+        }
+        ReleaseSlot(index);
+
+        if (parent >= 0)
+        {
+            FinishJob(parent);
+        }
     }
 }
 
 
 bool JobManager::IsFinished(JobID id) {
 
-    return mJobs[id].unfinishedCount == 0;
+    if (id < 0)
+    {
+        return true;
+    }
+
+    // a different generation means the job finished and its slot has been reused since
+    const Job &job = mJobs[SlotIndex(id)];
+
+    return job.generation.load(std::memory_order_acquire) != Generation(id) || (job.unfinishedCount.load(std::memory_order_acquire) & ~WAITER_FLAG) == 0;
+}
+
+
+bool JobManager::AcquireSlot(Size &index) {
+
+    U64 head = mFreeSlots.load(std::memory_order_acquire);
+    U64 newHead;
+    do
+    {
+        if ((head & 0xFFFFFFFF) == 0)
+        {
+            return false;
+        }
+
+        U64 next = mNextFreeSlots[(head & 0xFFFFFFFF) - 1].load(std::memory_order_relaxed);
+        newHead = ((head >> 32) + 1) << 32 | next;
+    }
+    while (!mFreeSlots.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire));
+
+    index = (Size)(head & 0xFFFFFFFF) - 1;
+    return true;
+}
+
+
+void JobManager::ReleaseSlot(Size index) {
+
+    Job &job = mJobs[index];
+
+    // release captured state right away, generations stay positive so that JobIDs do too
+    job.task = nullptr;
+    U32 generation = job.generation.load(std::memory_order_relaxed) + 1;
+    job.generation.store(generation < 0x80000000 ? generation : 1, std::memory_order_release);
+
+    U64 head = mFreeSlots.load(std::memory_order_relaxed);
+    U64 newHead;
+    do
+    {
+        mNextFreeSlots[index].store((U32)(head & 0xFFFFFFFF), std::memory_order_relaxed);
+        newHead = ((head >> 32) + 1) << 32 | (index + 1);
+    }
+    while (!mFreeSlots.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
 }
 
 
@@ -6,10 +6,16 @@
 #include "Core/Util/Types.h"
 #include "Core/Debug/Log.h"
 #include "Core/DataStructures/Array.h"
-#include "Core/DataStructures/ConcurrentQueue.h"
-
-// #include <boost/fiber/all.hpp>
-#include <condition_variable>
+#include "Core/DataStructures/Queue.h"
+#include "Core/DataStructures/WorkStealingQueue.h"
+#include "Core/Memory/Memory.h"
+#include "Core/Memory/MemoryTag.h"
+#include "CpuTopology.h"
+#include "Fiber.h"
+#include "JobTrace.h"
+#include "Task.h"
+
+#include <algorithm>
 #include <functional>
 #include <mutex>
 #include <thread>
@@ -18,27 +24,116 @@
 namespace Atuin {
 
 
+// generation << 32 | slot index, negative ids are invalid
 using JobID = int64_t;
-using Task  = std::function<void(void*)>;
+
+
+enum class JobPriority : U8 {
+
+    // work the current frame waits on
+    HIGH,
+    NORMAL,
+    // long running work like asset loading, at most BACKGROUND_JOB_THREADS workers run it at a time and never the main thread
+    BACKGROUND,
+
+    COUNT
+};
 
 
 class EngineLoop;
 
+/* @brief Runs jobs on a pool of fibers per thread.
+ *        A job that waits for another one suspends its fiber and the thread continues with other jobs on a different fiber,
+ *        the waiting fiber is resumed once the awaited job has finished. Fibers stay on the thread that created them,
+ *        so fibers of the main thread only continue while the main thread is in Wait().
+ *        Waiting outside of a job runs the scheduler on the calling thread until the job has finished.
+ *        Threads the JobManager does not own, e.g. I/O threads, may create, run and wait on jobs as well,
+ *        their jobs go through a shared queue per priority and waiting just yields until the job has finished.
+ */
 class JobManager {
 
 
-struct Job {
+struct JobFiber;
+
+struct alignas(64) Job {
 
     Task task;
     void *data = nullptr;
     JobID parent = -1;
+    // the highest bit is WAITER_FLAG, set once a fiber is suspended in Wait() on this job
     std::atomic<U32> unfinishedCount = 0;
-    Byte padding[64 - sizeof(Task) - sizeof(JobID) - sizeof(unfinishedCount) - sizeof(void*)];
+    // bumped every time the slot is released, so that ids of finished jobs are not mistaken for the job reusing the slot
+    std::atomic<U32> generation = 1;
+};
+
+static_assert(sizeof(Job) == 64, "Job does not fit into a single cache line.");
+
+static constexpr U32 WAITER_FLAG = 1u << 31;
+
+
+struct JobFiber {
+
+    JobFiber(JobManager *manager, Size thread) : fiber(pFiberStackSize->Get(), &JobManager::FiberMain, manager), threadID {thread} {}
+
+    Fiber fiber;
+    Size threadID;
+    // background jobs executing on this fiber, nested if a job helps out in CreateJob()
+    Size numBackgroundJobs = 0;
+    // next fiber waiting on the same job
+    JobFiber *nextWaiting = nullptr;
+    // job executing on this fiber and start of its current trace segment, -1 while not tracing
+    JobID traceJob = -1;
+    U64 traceBegin = 0;
+    // MemoryTagScope tag of the fiber while it is switched out, scopes stay open across Wait()
+    MemoryTag memoryTag = MemoryTag::GENERAL;
+};
+
+
+// park states of a worker thread
+static constexpr U32 RUNNING = 0;
+static constexpr U32 PARKED = 1;
+
+// scheduler state of one thread, only touched by that thread except for the ready list and park state
+struct FiberThread {
+
+    // context of the thread itself, the scheduler runs here
+    Fiber scheduler;
+    // fiber running on this thread, nullptr while the scheduler runs
+    JobFiber *current = nullptr;
+
+    Array<JobFiber*> fibers;
+    Array<JobFiber*> freeFibers;
+
+    // suspended fibers whose job can continue, filled by whichever thread finishes the awaited job
+    Array<JobFiber*> readyFibers;
+    std::atomic<Size> numReady = 0;
+    std::mutex readyLock;
+
+    // job after which the scheduler returns, -1 runs until ShutDown()
+    JobID waitFor = -1;
+    // job the current fiber is about to wait on, picked up by the scheduler after the switch
+    JobID pendingWait = -1;
+    // the current fiber found no job to run
+    bool idle = false;
+
+    // PARKED while the worker sleeps in Park(), a waking thread swaps it back to RUNNING
+    std::atomic<U32> parkState = RUNNING;
+};
+
+
+// jobs run by threads without a FiberThread, they can not push to the work-stealing queues
+struct ExternalQueue {
+
+    std::mutex lock;
+    Queue<JobID> jobs;
+    // lets GetJob() skip the lock while the queue is empty
+    std::atomic<Size> size = 0;
 };
 
 
 public:
 
+    // numThreads 0 takes NUM_WORKER_THREADS, if that is 0 too there is one worker per physical core besides the main thread's
     JobManager(Size numThreads = 0);
     ~JobManager();
 
@@ -46,42 +141,163 @@ public:
     void StartUp();
     void ShutDown();
 
-    JobID CreateJob(Task task, void *jobData, JobID parent = -1);
+    // if all MAX_JOBS_PER_FRAME slots are in flight the calling thread executes queued jobs until one is released
+    JobID CreateJob(Task task, void *jobData, JobID parent = -1, JobPriority priority = JobPriority::NORMAL);
     void  Run(JobID id);
+    // inside a job the calling fiber is suspended, the thread keeps running other jobs meanwhile
     void  Wait(JobID id);
-
+    // the job is run by the next BeginFrame(), jobs still pending at ShutDown() never run
+    void  RunNextFrame(JobID id);
+    // called by the engine loop once at the start of every frame
+    void  BeginFrame();
+
+    // Calls fn(first, last) on disjoint subranges covering [begin, end) and returns once all of them are done.
+    // The range is split in halves recursively until subranges are at most grainSize long, 
+    // idle threads steal the oldest and therefore largest halves. grainSize 0 picks one from the number of threads.
+    // All subrange jobs run at priority, so frame critical ranges do not queue behind NORMAL jobs.
+    void ParallelRange(Size begin, Size end, const std::function<void(Size, Size)> &fn, Size grainSize = 0, JobPriority priority = JobPriority::NORMAL);
+
+    // Calls fn(i) for every i in [begin, end), see ParallelRange().
+    template<typename F>
+    void ParallelFor(Size begin, Size end, F &&fn, Size grainSize = 0, JobPriority priority = JobPriority::NORMAL);
+
+    // EXTERNAL_THREAD on threads the JobManager does not own
     Size ThisThread() const { return sThreadID; }
+    Size NumThreads() const { return mNumThreads + 1; }
+    const CpuTopology& Topology() const { return mTopology; }
+
+    // Records job executions, steals and idle periods of every thread into JOB_TRACE_EVENTS sized ring buffers.
+    void StartTrace();
+    void StopTrace();
+    // Chrome trace event JSON of the recorded events, open it in chrome://tracing or ui.perfetto.dev
+    std::string ExportTrace() const;
+    const JobTracer& Tracer() const { return mTracer; }
 
 private:
 
-    // static CVar<U8>* pMaxFibersOnThread;
+    static CVar<U8>* pMaxFibersOnThread;
+    static CVar<Size>* pFiberStackSize;
     static CVar<Size>* pMaxJobsPerFrame;
+    static CVar<U32>* pWorkerSpinCount;
+    static CVar<Size>* pBackgroundJobThreads;
+    static CVar<U32>* pNumWorkerThreads;
+    static CVar<bool>* pPinThreads;
+    static CVar<Size>* pJobTraceEvents;
 
     static thread_local Size sThreadID;
 
+public:
+
+    static constexpr Size EXTERNAL_THREAD = ~(Size)0;
+
+private:
+
+
+    struct ParallelRangeData {
+
+        const std::function<void(Size, Size)> *fn;
+        Size grainSize;
+        JobPriority priority;
+        JobID root;
+    };
+
 
     void WorkerThread(Size threadID);
+    void SetUpThread(Size threadID);
+    void Schedule(FiberThread &thread);
+    bool IsSchedulerDone(FiberThread &thread);
+    void SwitchToScheduler(FiberThread &thread);
+    static void FiberMain(void *manager);
+
+    void Park(FiberThread &thread);
+    bool HasWork(FiberThread &thread);
+    bool Wake(FiberThread &thread);
+    void WakeOne();
+    bool IsExternalThread() const { return sThreadID == EXTERNAL_THREAD; }
+    void RunExternal(JobID id);
+    JobID PopExternalJob(JobPriority priority);
+
+    JobFiber* AcquireFiber(FiberThread &thread);
+    JobFiber* PopReadyFiber(FiberThread &thread);
+    void ParkFiber(JobFiber *fiber, JobID id);
+    void ResumeWaiters(Size index);
+    void ReadyFiber(JobFiber *fiber);
+
+    void SplitRange(ParallelRangeData *range, Size begin, Size end);
     JobID GetJob();
+    JobID GetJob(JobPriority priority);
+    bool  CanRunBackgroundJob();
+    void  ReleaseBackgroundJobs(Size count);
+    Size  MaxBackgroundJobs() const { return std::max(pBackgroundJobThreads->Get(), (Size)1); }
+    WorkStealingQueue<JobID>& JobQueue(Size threadID, JobPriority priority) { return mJobQueues[ (Size)priority * (mNumThreads + 1) + threadID ]; }
     void ExecuteJob(JobID id);
     void FinishJob(JobID id);
     bool IsFinished(JobID id);
+
+    bool AcquireSlot(Size &index);
+    void ReleaseSlot(Size index);
+
+    static Size  SlotIndex(JobID id) { return (Size)(id & 0xFFFFFFFF); }
+    static U32   Generation(JobID id) { return (U32)(id >> 32); }
+    static JobID MakeJobID(Size index, U32 generation) { return (JobID)generation << 32 | (JobID)index; }
     
 
     std::atomic_bool mActive;
 
-    std::atomic<JobID> mNumJobs;
     Array<Job> mJobs;
+    // lock-free stack of free job slots, ABA tag << 32 | (index + 1), 0 if empty
+    std::atomic<U64> mFreeSlots;
+    // per slot index + 1 of the next free slot while it is in the free list
+    Array<std::atomic<U32>> mNextFreeSlots;
+    // per slot priority of the job, decides the queue Run() pushes it to
+    Array<JobPriority> mJobPriorities;
+
+    CpuTopology mTopology;
+    // cpu of thread i is mPinOrder[(i + 1) % size], the main thread gets the first one
+    Array<U32> mPinOrder;
 
     Size mNumThreads;
     Array<std::thread> mThreads;
-    Array<ConcurrentQueue<JobID>> mJobQueues;
+    // per priority one queue for each worker thread plus one for the main thread, see JobQueue()
+    // queues grow if more jobs are queued than MAX_JOBS_PER_FRAME
+    Array<WorkStealingQueue<JobID>> mJobQueues;
+    // created jobs waiting for the next BeginFrame()
+    Array<JobID> mNextFrameJobs;
+    std::mutex mNextFrameLock;
+
+    // one per priority, see ExternalQueue
+    Array<ExternalQueue> mExternalQueues;
+    // background jobs currently executed or suspended in Wait()
+    std::atomic<Size> mNumBackgroundJobs;
+
+    // one per worker thread plus one for the main thread
+    Array<FiberThread> mFiberThreads;
+    // per job slot list of fibers waiting on it, linked by JobFiber::nextWaiting
+    Array<JobFiber*> mWaitingFibers;
+    std::mutex mWaitLock;
 
-    std::condition_variable mJobsReadyCV;
-    std::mutex mJobsReadyLock;
+    // number of workers in PARKED state, lets Run() skip looking for one to wake
+    std::atomic<Size> mNumParked;
+
+    JobTracer mTracer;
 
     Log mLog;
+    Memory mMemory;
 };
 
+
+template<typename F>
+void JobManager::ParallelFor(Size begin, Size end, F &&fn, Size grainSize, JobPriority priority) {
+
+    ParallelRange(begin, end, [&fn](Size first, Size last) {
+
+        for (Size i = first; i < last; i++)
+        {
+            fn(i);
+        }
+    }, grainSize, priority);
+}
+
     
 } // Atuin
  
\ No newline at end of file
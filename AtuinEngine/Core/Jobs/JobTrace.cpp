@@ -0,0 +1,149 @@
+#include "JobTrace.h"
+#include "Core/Util/StringFormat.h"
+
+#include <algorithm>
+#include <sstream>
+
+
+namespace Atuin {
+
+
+namespace {
+
+
+const char* PriorityName(U32 priority) {
+
+    // same order as JobPriority
+    constexpr const char* names[] = { "HIGH", "NORMAL", "BACKGROUND" };
+
+    return priority < 3 ? names[priority] : "UNKNOWN";
+}
+
+
+} // anonymous
+
+
+JobTracer::JobTracer() : mBuffers(), mStart {std::chrono::steady_clock::now()}, mEnabled {false} {
+
+}
+
+
+void JobTracer::Init(Size numThreads, Size eventsPerThread) {
+
+    mBuffers = Array<ThreadBuffer>(numThreads);
+    for (Size i = 0; i < numThreads; i++)
+    {
+        mBuffers.EmplaceBack( std::max(eventsPerThread, (Size)1) );
+    }
+    mStart = std::chrono::steady_clock::now();
+}
+
+
+void JobTracer::Clear() {
+
+    for (ThreadBuffer &buffer : mBuffers)
+    {
+        buffer.head.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+U64 JobTracer::Now() const {
+
+    return (U64)std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - mStart ).count();
+}
+
+
+void JobTracer::Record(Size thread, const TraceEvent &event) {
+
+    if (thread >= mBuffers.GetSize())
+    {
+        return;
+    }
+
+    // single writer, the release lets ExportChromeJson() see the event once it sees the new head
+    ThreadBuffer &buffer = mBuffers[thread];
+    U64 head = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[ head % buffer.events.GetSize() ] = event;
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+
+Size JobTracer::NumEvents(Size thread) const {
+
+    const ThreadBuffer &buffer = mBuffers[thread];
+
+    return (Size)std::min( buffer.head.load(std::memory_order_acquire), (U64)buffer.events.GetSize() );
+}
+
+
+Size JobTracer::NumEvents(Size thread, TraceEventType type) const {
+
+    const ThreadBuffer &buffer = mBuffers[thread];
+    Size numHeld = NumEvents(thread);
+
+    // the held events are the last numHeld slots before head, wrapped around the ring
+    U64 head = buffer.head.load(std::memory_order_acquire);
+    Size count = 0;
+    for (U64 i = head - numHeld; i < head; i++)
+    {
+        count += buffer.events[ i % buffer.events.GetSize() ].type == type ? 1 : 0;
+    }
+    return count;
+}
+
+
+std::string JobTracer::ExportChromeJson(const Array<std::string> &threadNames) const {
+
+    std::ostringstream json;
+    json << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    bool first = true;
+    auto separator = [&]() -> const char* { 
+        
+        const char *comma = first ? "\n" : ",\n";
+        first = false;
+        return comma;
+    };
+
+    for (Size thread = 0; thread < mBuffers.GetSize(); thread++)
+    {
+        const char *name = thread < threadNames.GetSize() ? threadNames[thread].c_str() : "Unknown";
+        json << separator() << FormatStr("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", (int)thread, name);
+        json << separator() << FormatStr("{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"sort_index\":%d}}", (int)thread, (int)thread);
+
+        const ThreadBuffer &buffer = mBuffers[thread];
+        U64 head = buffer.head.load(std::memory_order_acquire);
+        U64 capacity = buffer.events.GetSize();
+
+        for (U64 i = head > capacity ? head - capacity : 0; i < head; i++)
+        {
+            const TraceEvent &event = buffer.events[ i % capacity ];
+            double begin = (double)event.begin / 1000.0;
+            double duration = (double)(event.end - event.begin) / 1000.0;
+
+            switch (event.type)
+            {
+                case TraceEventType::JOB:
+                    json << separator() << FormatStr("{\"name\":\"Job %s\",\"cat\":\"job\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%d,\"args\":{\"id\":%lld}}", 
+                        PriorityName(event.info), begin, duration, (int)thread, (long long)event.job);
+                    break;
+                case TraceEventType::STEAL:
+                    json << separator() << FormatStr("{\"name\":\"Steal\",\"cat\":\"steal\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":0,\"tid\":%d,\"args\":{\"id\":%lld,\"victim\":%d}}", 
+                        begin, (int)thread, (long long)event.job, (int)event.info);
+                    break;
+                case TraceEventType::IDLE:
+                    json << separator() << FormatStr("{\"name\":\"Idle\",\"cat\":\"idle\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%d}", 
+                        begin, duration, (int)thread);
+                    break;
+            }
+        }
+    }
+
+    json << "\n]}\n";
+
+    return json.str();
+}
+
+
+} // Atuin
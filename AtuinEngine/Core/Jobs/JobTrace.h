@@ -0,0 +1,85 @@
+#pragma once
+
+
+#include "Core/Util/Types.h"
+#include "Core/DataStructures/Array.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+
+namespace Atuin {
+
+
+enum class TraceEventType : U8 {
+
+    // one execution segment of a job, a job suspended in Wait() has a segment before and after
+    JOB,
+    // a job taken from another thread's queue, begin == end
+    STEAL,
+    // time a worker spent spinning or parked without work
+    IDLE
+};
+
+
+struct TraceEvent {
+
+    // nanoseconds since the tracer was initialized
+    U64 begin;
+    U64 end;
+    // JobID, -1 for IDLE
+    I64 job;
+    // JOB: priority, STEAL: thread the job was stolen from
+    U32 info;
+    TraceEventType type;
+};
+
+
+/* @brief Ring buffer of job system events per thread, exported as Chrome trace event JSON for chrome://tracing or Perfetto.
+ *        Every buffer is only written by its own thread without locks, the oldest events are overwritten once it is full.
+ *        Events recorded while Clear() or ExportChromeJson() run may be lost or torn, so start, stop and export while the job system is idle.
+ */
+class JobTracer {
+
+    struct alignas(64) ThreadBuffer {
+
+        ThreadBuffer(Size capacity) : events(capacity, TraceEvent{}) {}
+
+        Array<TraceEvent> events;
+        // total number of events written, the next one goes to head % capacity
+        std::atomic<U64> head = 0;
+    };
+
+
+public:
+
+    JobTracer();
+
+    // not thread-safe, call before any thread records
+    void Init(Size numThreads, Size eventsPerThread);
+
+    bool IsEnabled() const { return mEnabled.load(std::memory_order_relaxed); }
+    void SetEnabled(bool enabled) { mEnabled.store(enabled, std::memory_order_relaxed); }
+    void Clear();
+
+    U64  Now() const;
+    void Record(Size thread, const TraceEvent &event);
+
+    // Number of events currently held for the thread, at most eventsPerThread.
+    Size NumEvents(Size thread) const;
+    // Same, only counting events of one type. A job suspended in Wait() counts as two JOB events.
+    Size NumEvents(Size thread, TraceEventType type) const;
+    // threadNames has one name per thread, events are timed in microseconds
+    std::string ExportChromeJson(const Array<std::string> &threadNames) const;
+
+
+private:
+
+    Array<ThreadBuffer> mBuffers;
+    std::chrono::steady_clock::time_point mStart;
+    std::atomic_bool mEnabled;
+};
+
+
+} // Atuin
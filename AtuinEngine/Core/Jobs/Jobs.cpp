@@ -8,11 +8,11 @@ namespace Atuin {
 JobManager* Jobs::sJobManager = nullptr;
     
 
-JobID Jobs::CreateJob(Task task, void *jobData, JobID parent) {
+JobID Jobs::CreateJob(Task task, void *jobData, JobID parent, JobPriority priority) {
 
     if (sJobManager != nullptr)
     {
-        return sJobManager->CreateJob(task, jobData, parent);
+        return sJobManager->CreateJob(std::move(task), jobData, parent, priority);
     }
     
     return -1;
@@ -37,6 +37,39 @@ void  Jobs::Wait(JobID id) {
 }
 
 
+void Jobs::RunNextFrame(JobID id) {
+
+    if (sJobManager != nullptr)
+    {
+        sJobManager->RunNextFrame(id);
+    }
+}
+
+
+void Jobs::BeginFrame() {
+
+    if (sJobManager != nullptr)
+    {
+        sJobManager->BeginFrame();
+    }
+}
+
+
+void Jobs::ParallelRange(Size begin, Size end, const std::function<void(Size, Size)> &fn, Size grainSize, JobPriority priority) {
+
+    if (sJobManager != nullptr)
+    {
+        sJobManager->ParallelRange(begin, end, fn, grainSize, priority);
+        return;
+    }
+
+    if (begin < end)
+    {
+        fn(begin, end);
+    }
+}
+
+
 Size Jobs::ThisThread() {
 
     if (sJobManager != nullptr)
@@ -48,4 +81,33 @@ Size Jobs::ThisThread() {
 }
 
 
+void Jobs::StartTrace() {
+
+    if (sJobManager != nullptr)
+    {
+        sJobManager->StartTrace();
+    }
+}
+
+
+void Jobs::StopTrace() {
+
+    if (sJobManager != nullptr)
+    {
+        sJobManager->StopTrace();
+    }
+}
+
+
+std::string Jobs::ExportTrace() {
+
+    if (sJobManager != nullptr)
+    {
+        return sJobManager->ExportTrace();
+    }
+
+    return std::string();
+}
+
+
 } // Atuin
@@ -16,16 +16,48 @@ class Jobs {
 
 public:
 
-    JobID CreateJob(Task task, void *jobData, JobID parent = -1);
+    bool Ready() const { return sJobManager != nullptr; }
+
+    JobID CreateJob(Task task, void *jobData, JobID parent = -1, JobPriority priority = JobPriority::NORMAL);
     void  Run(JobID id);
     void  Wait(JobID id);
+    void  RunNextFrame(JobID id);
+    void  BeginFrame();
+
+    // split [begin, end) into subranges processed in parallel, runs serially if JobManager is not initialized
+    void ParallelRange(Size begin, Size end, const std::function<void(Size, Size)> &fn, Size grainSize = 0, JobPriority priority = JobPriority::NORMAL);
+
+    template<typename F>
+    void ParallelFor(Size begin, Size end, F &&fn, Size grainSize = 0, JobPriority priority = JobPriority::NORMAL);
 
     Size ThisThread();
 
+    // see JobManager::StartTrace()
+    void StartTrace();
+    void StopTrace();
+    // empty without JobManager
+    std::string ExportTrace();
+
 private:
 
     static JobManager* sJobManager;
 };
 
+
+template<typename F>
+void Jobs::ParallelFor(Size begin, Size end, F &&fn, Size grainSize, JobPriority priority) {
+
+    if (sJobManager != nullptr)
+    {
+        sJobManager->ParallelFor(begin, end, std::forward<F>(fn), grainSize, priority);
+        return;
+    }
+
+    for (Size i = begin; i < end; i++)
+    {
+        fn(i);
+    }
+}
+
     
 } // Atuin
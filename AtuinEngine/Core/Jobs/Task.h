@@ -0,0 +1,132 @@
+#pragma once
+
+
+#include "Core/Util/Types.h"
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace Atuin {
+
+
+/* @brief Move-only void(void*) callable that stores its captures inline.
+ *        Unlike std::function it never allocates, callables larger than CAPACITY are rejected at compile time,
+ *        capture a pointer to the data instead or pass it as the job data.
+ */
+class Task {
+
+    struct VTable {
+
+        void (*invoke)(void *storage, void *data);
+        void (*move)(void *dst, void *src);
+        void (*destroy)(void *storage);
+    };
+
+    template<typename F>
+    static constexpr VTable sVTable = {
+        [](void *storage, void *data) { (*static_cast<F*>(storage))(data); },
+        [](void *dst, void *src) { new (dst) F( std::move(*static_cast<F*>(src)) ); static_cast<F*>(src)->~F(); },
+        [](void *storage) { static_cast<F*>(storage)->~F(); }
+    };
+
+
+public:
+
+    // together with the vtable pointer this keeps a job in a single cache line
+    static constexpr Size CAPACITY = 32;
+
+
+    Task() : pVTable {nullptr} {}
+    Task(std::nullptr_t) : pVTable {nullptr} {}
+
+    template<typename F, typename = std::enable_if_t< !std::is_same_v<std::decay_t<F>, Task> >>
+    Task(F &&fn);
+
+    Task(const Task&) = delete;
+    Task(Task &&other) noexcept;
+
+    Task& operator= (const Task&) = delete;
+    Task& operator= (Task &&rhs) noexcept;
+    Task& operator= (std::nullptr_t);
+
+    ~Task() { Reset(); }
+
+
+    void operator()(void *data) { assert(pVTable != nullptr); pVTable->invoke(mStorage, data); }
+    explicit operator bool() const { return pVTable != nullptr; }
+
+
+private:
+
+    void Reset();
+
+
+    const VTable *pVTable;
+    alignas(alignof(void*)) Byte mStorage[CAPACITY];
+};
+
+
+template<typename F, typename>
+Task::Task(F &&fn) {
+
+    using Callable = std::decay_t<F>;
+
+    static_assert(sizeof(Callable) <= CAPACITY, "Task captures too much state, capture a pointer to it instead.");
+    static_assert(alignof(Callable) <= alignof(void*), "Task captures over-aligned state.");
+    static_assert(std::is_invocable_v<Callable&, void*>, "Task has to be callable as void(void*).");
+
+    new (mStorage) Callable( std::forward<F>(fn) );
+    pVTable = &sVTable<Callable>;
+}
+
+
+inline Task::Task(Task &&other) noexcept : pVTable {other.pVTable} {
+
+    if (pVTable != nullptr)
+    {
+        pVTable->move(mStorage, other.mStorage);
+        other.pVTable = nullptr;
+    }
+}
+
+
+inline Task& Task::operator= (Task &&rhs) noexcept {
+
+    if (this != &rhs)
+    {
+        Reset();
+
+        pVTable = rhs.pVTable;
+        if (pVTable != nullptr)
+        {
+            pVTable->move(mStorage, rhs.mStorage);
+            rhs.pVTable = nullptr;
+        }
+    }
+
+    return *this;
+}
+
+
+inline Task& Task::operator= (std::nullptr_t) {
+
+    Reset();
+    return *this;
+}
+
+
+inline void Task::Reset() {
+
+    if (pVTable != nullptr)
+    {
+        pVTable->destroy(mStorage);
+        pVTable = nullptr;
+    }
+}
+
+
+} // Atuin
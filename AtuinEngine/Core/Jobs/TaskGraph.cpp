@@ -0,0 +1,174 @@
+#include "TaskGraph.h"
+
+#include <cassert>
+
+
+namespace Atuin {
+
+
+TaskGraph::TaskGraph() : mNodes(), mPendingPredecessors(), mOrder(), mCompiled {false}, mRoot {-1}, mJobs(), mLog() {
+
+}
+
+
+TaskGraph::~TaskGraph() {
+
+    // node jobs reference this graph
+    Wait();
+}
+
+
+TaskNodeID TaskGraph::AddNode(Task task, void *data, JobPriority priority) {
+
+    assert(!IsRunning());
+
+    mNodes.EmplaceBack( Node{ std::move(task), data, priority, Array<TaskNodeID>(), 0 } );
+    mCompiled = false;
+
+    return mNodes.GetSize() - 1;
+}
+
+
+void TaskGraph::AddEdge(TaskNodeID before, TaskNodeID after) {
+
+    assert(!IsRunning());
+    assert(before < mNodes.GetSize() && after < mNodes.GetSize());
+
+    mNodes[before].successors.PushBack(after);
+    mNodes[after].numPredecessors++;
+    mCompiled = false;
+}
+
+
+void TaskGraph::Clear() {
+
+    assert(!IsRunning());
+
+    mNodes.Clear();
+    mPendingPredecessors.Clear();
+    mOrder.Clear();
+    mCompiled = false;
+}
+
+
+void TaskGraph::Run() {
+
+    assert(!IsRunning());
+
+    if (!mCompiled)
+    {
+        Compile();
+    }
+    // nothing to do or a cycle
+    if (!mCompiled || mNodes.IsEmpty())
+    {
+        return;
+    }
+
+    for (Size i = 0; i < mNodes.GetSize(); i++)
+    {
+        mPendingPredecessors[i].store(mNodes[i].numPredecessors, std::memory_order_relaxed);
+    }
+
+    // no JobManager -> run everything right here
+    mRoot = mJobs.CreateJob( [](void*){}, nullptr);
+    if (mRoot < 0)
+    {
+        for (TaskNodeID id : mOrder)
+        {
+            mNodes[id].task(mNodes[id].data);
+        }
+        return;
+    }
+
+    for (TaskNodeID id = 0; id < mNodes.GetSize(); id++)
+    {
+        if (mNodes[id].numPredecessors == 0)
+        {
+            Launch(id);
+        }
+    }
+
+    // the root only finishes once all node jobs have, they are its children
+    mJobs.Run(mRoot);
+}
+
+
+void TaskGraph::Wait() {
+
+    if (!IsRunning())
+    {
+        return;
+    }
+
+    mJobs.Wait(mRoot);
+    mRoot = -1;
+}
+
+
+void TaskGraph::Compile() {
+
+    // topological sort, leftover nodes are part of a cycle
+    Array<U32> numPredecessors( mNodes.GetSize());
+    mOrder.Clear();
+    mOrder.Reserve( mNodes.GetSize());
+
+    for (TaskNodeID id = 0; id < mNodes.GetSize(); id++)
+    {
+        numPredecessors.PushBack( mNodes[id].numPredecessors);
+        if (mNodes[id].numPredecessors == 0)
+        {
+            mOrder.PushBack(id);
+        }
+    }
+    for (Size i = 0; i < mOrder.GetSize(); i++)
+    {
+        for (TaskNodeID successor : mNodes[ mOrder[i] ].successors)
+        {
+            if (--numPredecessors[successor] == 0)
+            {
+                mOrder.PushBack(successor);
+            }
+        }
+    }
+
+    if (mOrder.GetSize() != mNodes.GetSize())
+    {
+        mLog.Error(LogChannel::GENERAL, "Task graph contains a cycle.");
+        return;
+    }
+
+    mPendingPredecessors = Array<std::atomic<U32>>( mNodes.GetSize());
+    for (Size i = 0; i < mNodes.GetSize(); i++)
+    {
+        mPendingPredecessors.EmplaceBack(0u);
+    }
+
+    mCompiled = true;
+}
+
+
+void TaskGraph::Launch(TaskNodeID id) {
+
+    JobID job = mJobs.CreateJob( [this, id](void*){ ExecuteNode(id); }, nullptr, mRoot, mNodes[id].priority);
+    mJobs.Run(job);
+}
+
+
+void TaskGraph::ExecuteNode(TaskNodeID id) {
+
+    Node &node = mNodes[id];
+    node.task(node.data);
+
+    // the last predecessor to finish launches the successor
+    for (TaskNodeID successor : node.successors)
+    {
+        if (mPendingPredecessors[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            Launch(successor);
+        }
+    }
+}
+
+
+} // Atuin
@@ -0,0 +1,80 @@
+#pragma once
+
+
+#include "Jobs.h"
+#include "Core/DataStructures/Array.h"
+#include "Core/Debug/Log.h"
+
+#include <atomic>
+
+
+namespace Atuin {
+
+
+using TaskNodeID = Size;
+
+
+/* @brief Set of tasks with "runs after" edges between them, built once and executed as often as needed, e.g. once per frame.
+ *        Execute() launches every node as a job as soon as all of its predecessors have finished,
+ *        so independent chains overlap as far as their dependencies allow. Runs the nodes one after another if JobManager is not initialized.
+ */
+class TaskGraph {
+
+    struct Node {
+
+        Task task;
+        void *data;
+        JobPriority priority;
+        Array<TaskNodeID> successors;
+        U32 numPredecessors;
+    };
+
+
+public:
+
+    TaskGraph();
+    ~TaskGraph();
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator= (const TaskGraph&) = delete;
+
+
+    // nodes and edges can only be added while the graph is not running
+    TaskNodeID AddNode(Task task, void *data = nullptr, JobPriority priority = JobPriority::NORMAL);
+    // after only starts once before has finished
+    void AddEdge(TaskNodeID before, TaskNodeID after);
+    void Clear();
+
+    // Starts all nodes without predecessors and returns right away.
+    void Run();
+    // Waits until every node has finished, inside a job only the calling fiber is suspended.
+    void Wait();
+    void Execute() { Run(); Wait(); }
+
+    bool IsRunning() const { return mRoot >= 0; }
+    Size NumNodes() const { return mNodes.GetSize(); }
+
+
+private:
+
+    void Compile();
+    void Launch(TaskNodeID id);
+    void ExecuteNode(TaskNodeID id);
+
+
+    Array<Node> mNodes;
+    // predecessors of each node that have not finished in the current run
+    Array<std::atomic<U32>> mPendingPredecessors;
+    // node order that respects all edges, used to run without JobManager
+    Array<TaskNodeID> mOrder;
+    bool mCompiled;
+
+    // all node jobs of a run are children of this job
+    JobID mRoot;
+
+    Jobs mJobs;
+    Log mLog;
+};
+
+
+} // Atuin
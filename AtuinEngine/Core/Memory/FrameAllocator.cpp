@@ -0,0 +1,82 @@
+
+#include "FrameAllocator.h"
+
+
+namespace Atuin {
+
+
+FrameAllocator::FrameAllocator(Size bufferSize, Size numBuffers, IAllocator *parent) :
+    IAllocator(bufferSize * numBuffers),
+    mCurrentBuffer {0}
+{
+    assert(numBuffers > 0);
+
+    for (Size i = 0; i < numBuffers; i++)
+    {
+        mBuffers.push_back( std::make_unique<StackAllocator>(bufferSize, parent) );
+    }
+}
+
+
+FrameAllocator::~FrameAllocator() {
+
+    // stack allocators have to be freed in reverse order if they share a stack parent
+    while (!mBuffers.empty())
+    {
+        mBuffers.pop_back();
+    }
+}
+
+
+void* FrameAllocator::Allocate(Size size, U8 alignment) {
+
+    StackAllocator &buffer = *mBuffers[mCurrentBuffer];
+    void *mem = buffer.Allocate(size, alignment);
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    mUsedMemory = 0;
+    for (auto &stack : mBuffers)
+    {
+        mUsedMemory += stack->UsedMemory();
+    }
+    mMaxUsedMemory = std::max(mMaxUsedMemory, mUsedMemory);
+
+    return mem;
+}
+
+
+void FrameAllocator::Free(void *ptr) {
+
+    // memory is released all at once in BeginFrame()
+    (void)ptr;
+}
+
+
+void FrameAllocator::Clear() {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    for (auto &stack : mBuffers)
+    {
+        stack->Clear();
+    }
+    mCurrentBuffer = 0;
+    mUsedMemory = 0;
+}
+
+
+void FrameAllocator::BeginFrame() {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    mCurrentBuffer = (mCurrentBuffer + 1) % mBuffers.size();
+    mUsedMemory -= mBuffers[mCurrentBuffer]->UsedMemory();
+    mBuffers[mCurrentBuffer]->Clear();
+}
+
+
+} // Atuin
@@ -0,0 +1,48 @@
+#pragma once
+
+
+#include "IAllocator.h"
+#include "StackAllocator.h"
+
+#include <memory>
+#include <vector>
+
+
+namespace Atuin {
+
+
+/* @brief Linear allocator for transient per frame data.
+ *        Holds one StackAllocator per buffered frame, allocations are bumped from the buffer of the current frame.
+ *        Free() does nothing, a buffer is released as a whole when BeginFrame() cycles back to it,
+ *        so memory allocated during a frame stays valid for numBuffers frames.
+ */
+class FrameAllocator : public IAllocator {
+
+public:
+
+    FrameAllocator() = delete;
+    FrameAllocator(Size bufferSize, Size numBuffers, IAllocator *parent = nullptr);
+    ~FrameAllocator();
+
+
+    void* Allocate(Size size, U8 alignment) override;
+    void  Free(void *ptr) override;
+    void  Clear() override;
+
+    // Switches to the next buffer and releases everything that was allocated from it.
+    // Must not be called while other threads allocate from the current frame.
+    void BeginFrame();
+
+    Size CurrentBuffer() const { return mCurrentBuffer; }
+    Size NumBuffers()    const { return mBuffers.size(); }
+
+
+private:
+
+    // std::vector since Array itself allocates through the memory manager
+    std::vector<std::unique_ptr<StackAllocator>> mBuffers;
+    Size mCurrentBuffer;
+};
+
+
+} // Atuin
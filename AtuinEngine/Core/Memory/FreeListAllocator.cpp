@@ -8,8 +8,8 @@
 namespace Atuin {
 
 
-FreeListAllocator::FreeListAllocator(Size totalMemory, IAllocator *parent) :
-    IAllocator(totalMemory, parent)
+FreeListAllocator::FreeListAllocator(Size totalMemory, IAllocator *parent, const PageBacking &backing) :
+    IAllocator(totalMemory, parent, backing)
 {
     pHead = new (pBase) FreeNode{mTotalMemory};
 }
@@ -134,6 +134,14 @@ void FreeListAllocator::Free(void *ptr) {
 }
 
 
+Size FreeListAllocator::AllocationSize(const void *ptr) const {
+
+    const AllocHeader *header = reinterpret_cast<const AllocHeader*>( reinterpret_cast<UPtr>(ptr) - sizeof(AllocHeader) );
+
+    return header->adjustment + sizeof(AllocHeader) + header->size;
+}
+
+
 void FreeListAllocator::Clear() {
 
     // lock mutex
@@ -35,13 +35,14 @@ class FreeListAllocator : public IAllocator{
 public:
 
     FreeListAllocator() = delete;
-    FreeListAllocator(Size totalMemory, IAllocator *parent = nullptr);
+    FreeListAllocator(Size totalMemory, IAllocator *parent = nullptr, const PageBacking &backing = PageBacking{});
     ~FreeListAllocator();
 
     
     void* Allocate(Size size, U8 alignment) override;
     void Free(void *ptr) override;
     void Clear() override;
+    Size AllocationSize(const void *ptr) const override;
 
 
 private:
@@ -7,8 +7,8 @@
 namespace Atuin {
 
 
-FreeTreeAllocator::FreeTreeAllocator(Size totalMemory, IAllocator *parent) :
-    IAllocator(totalMemory, parent)
+FreeTreeAllocator::FreeTreeAllocator(Size totalMemory, IAllocator *parent, const PageBacking &backing) :
+    IAllocator(totalMemory, parent, backing)
 {
     pRoot = new (pBase) TreeNode(mTotalMemory);
 }
@@ -100,11 +100,30 @@ void FreeTreeAllocator::Free(void *ptr) {
     else
     {
         InsertNode(newNode);
-        UpdateMaxSize(newNode);
     }
 }
 
 
+Size FreeTreeAllocator::AllocationSize(const void *ptr) const {
+
+    const AllocHeader *header = reinterpret_cast<const AllocHeader*>( reinterpret_cast<UPtr>(ptr) - sizeof(AllocHeader) );
+
+    return header->adjustment + sizeof(AllocHeader) + header->size;
+}
+
+
+Size FreeTreeAllocator::NumFreeRegions() const {
+
+    return CountNodes(pRoot);
+}
+
+
+Size FreeTreeAllocator::TreeHeight() const {
+
+    return MeasureHeight(pRoot);
+}
+
+
 void FreeTreeAllocator::Clear() {
 
     // lock mutex
@@ -122,14 +141,15 @@ FreeTreeAllocator::TreeNode* FreeTreeAllocator::FindNode(Size size, TreeNode *ro
         return nullptr;
     }
 
-    if (root->size >= size)
+    // lower addresses first, keeps the high end of the memory free for large allocations
+    if (root->left != nullptr && root->left->maxSize >= size)
     {
-        return root;
+        return FindNode(size, root->left);
     }
 
-    if (root->left != nullptr && root->left->maxSize >= size)
+    if (root->size >= size)
     {
-        return FindNode(size, root->left);
+        return root;
     }
 
     return FindNode(size, root->right);
@@ -159,6 +179,9 @@ std::pair<FreeTreeAllocator::TreeNode*, FreeTreeAllocator::TreeNode*> FreeTreeAl
 
 void FreeTreeAllocator::InsertNode(TreeNode *newNode) {
 
+    // size might have grown by merging since the node was constructed
+    UpdateNode(newNode);
+
     if(pRoot == nullptr)
     {
         pRoot =  newNode;
@@ -169,8 +192,6 @@ void FreeTreeAllocator::InsertNode(TreeNode *newNode) {
     while (curr != nullptr)
     {
         prev = curr;
-        curr->maxSize = std::max(curr->maxSize, newNode->size);
-
         if (reinterpret_cast<UPtr>(newNode) < reinterpret_cast<UPtr>(curr))
         {
             curr = curr->left;
@@ -190,12 +211,14 @@ void FreeTreeAllocator::InsertNode(TreeNode *newNode) {
     {
         prev->right = newNode;
     }
+
+    Rebalance(prev);
 }
 
 
 void FreeTreeAllocator::RemoveNode(TreeNode *target) {
 
-    // Node from which to start the maxSize update
+    // Lowest node whose subtree changed, rebalancing starts from here
     TreeNode *sizeUpdateNode = target->parent;
     
     if (target->left == nullptr)
@@ -230,7 +253,7 @@ void FreeTreeAllocator::RemoveNode(TreeNode *target) {
         nextNode->left->parent = nextNode;
     }
 
-    UpdateMaxSize(sizeUpdateNode);
+    Rebalance(sizeUpdateNode);
 }
 
 
@@ -258,7 +281,9 @@ void FreeTreeAllocator::ReplaceNode(TreeNode *target, TreeNode *newNode) {
         newNode->right->parent = newNode;
     }
 
-    UpdateMaxSize(newNode->parent);  
+    // newNode takes the place of target, so the tree shape does not change
+    newNode->height = target->height;
+    UpdateMaxSize(newNode);  
 }
 
 
@@ -304,5 +329,110 @@ void FreeTreeAllocator::UpdateMaxSize(TreeNode *node) {
     }
 }
 
+
+void FreeTreeAllocator::UpdateNode(TreeNode *node) {
+
+    node->maxSize = node->size;
+    node->height = 1;
+    if (node->left != nullptr)
+    {
+        node->maxSize = std::max(node->maxSize, node->left->maxSize);
+        node->height = std::max(node->height, node->left->height + 1);
+    }
+
+    if (node->right != nullptr)
+    {
+        node->maxSize = std::max(node->maxSize, node->right->maxSize);
+        node->height = std::max(node->height, node->right->height + 1);
+    }
+}
+
+
+void FreeTreeAllocator::Rebalance(TreeNode *node) {
+
+    TreeNode *curr = node;
+    while (curr != nullptr)
+    {
+        UpdateNode(curr);
+
+        if (Height(curr->left) > Height(curr->right) + 1)
+        {
+            // left-right case needs an additional rotation of the left child
+            if (Height(curr->left->left) < Height(curr->left->right))
+            {
+                RotateLeft(curr->left);
+            }
+            curr = RotateRight(curr);
+        }
+        else if (Height(curr->right) > Height(curr->left) + 1)
+        {
+            // right-left case needs an additional rotation of the right child
+            if (Height(curr->right->right) < Height(curr->right->left))
+            {
+                RotateRight(curr->right);
+            }
+            curr = RotateLeft(curr);
+        }
+
+        curr = curr->parent;
+    }
+}
+
+
+FreeTreeAllocator::TreeNode* FreeTreeAllocator::RotateLeft(TreeNode *node) {
+
+    TreeNode *pivot = node->right;
+
+    node->right = pivot->left;
+    if (node->right != nullptr)
+    {
+        node->right->parent = node;
+    }
+
+    ShiftNodeUp(node, pivot);
+    pivot->left = node;
+    node->parent = pivot;
+
+    UpdateNode(node);
+    UpdateNode(pivot);
+
+    return pivot;
+}
+
+
+FreeTreeAllocator::TreeNode* FreeTreeAllocator::RotateRight(TreeNode *node) {
+
+    TreeNode *pivot = node->left;
+
+    node->left = pivot->right;
+    if (node->left != nullptr)
+    {
+        node->left->parent = node;
+    }
+
+    ShiftNodeUp(node, pivot);
+    pivot->right = node;
+    node->parent = pivot;
+
+    UpdateNode(node);
+    UpdateNode(pivot);
+
+    return pivot;
+}
+
+
+
+Size FreeTreeAllocator::CountNodes(const TreeNode *node) {
+
+    return node != nullptr ? 1 + CountNodes(node->left) + CountNodes(node->right) : 0;
+}
+
+
+// measured instead of read from the nodes, so wrong height bookkeeping is caught as well
+Size FreeTreeAllocator::MeasureHeight(const TreeNode *node) {
+
+    return node != nullptr ? 1 + std::max( MeasureHeight(node->left), MeasureHeight(node->right) ) : 0;
+}
+
     
 } // Atuin
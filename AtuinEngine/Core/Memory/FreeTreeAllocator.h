@@ -10,6 +10,9 @@
 namespace Atuin {
 
 
+/* @brief Keeps free memory regions in an address ordered AVL tree, where every node also stores the largest free region in its subtree.
+ *        Allocations take the lowest addressed region that is large enough, freed regions are merged with their neighbours.
+ */
 class FreeTreeAllocator : public IAllocator {
 
 
@@ -17,22 +20,25 @@ class FreeTreeAllocator : public IAllocator {
 
         Size size;
         Size maxSize;
+        Size height;
         TreeNode *parent;
         TreeNode *left;
         TreeNode *right;
 
-        TreeNode() : size {0}, maxSize {0}, parent {nullptr}, left {nullptr}, right {nullptr} {}
+        TreeNode() : size {0}, maxSize {0}, height {1}, parent {nullptr}, left {nullptr}, right {nullptr} {}
         TreeNode(const Size size_, TreeNode *parent_ = nullptr, TreeNode *left_ = nullptr, TreeNode *right_ = nullptr) : 
-            size {size_}, parent {parent_}, left {left_}, right {right_} 
+            size {size_}, height {1}, parent {parent_}, left {left_}, right {right_} 
         {
             maxSize = size;
             if (left != nullptr)
             {
                 maxSize = std::max(maxSize, left->maxSize);
+                height = std::max(height, left->height + 1);
             }
             if (right != nullptr)
             {
                 maxSize = std::max(maxSize, right->maxSize);
+                height = std::max(height, right->height + 1);
             }
         }
     };
@@ -47,13 +53,18 @@ class FreeTreeAllocator : public IAllocator {
 public:
 
     FreeTreeAllocator() = delete;
-    FreeTreeAllocator(Size totalMemory, IAllocator *parent);
+    FreeTreeAllocator(Size totalMemory, IAllocator *parent = nullptr, const PageBacking &backing = PageBacking{});
     ~FreeTreeAllocator();
 
 
     void* Allocate(Size size, U8 alignment) override;
     void  Free(void *ptr) override;
     void  Clear() override;
+    Size  AllocationSize(const void *ptr) const override;
+
+    // walk the tree of free regions for tests and debugging, not thread-safe
+    Size NumFreeRegions() const;
+    Size TreeHeight() const;
 
 
 private:
@@ -66,6 +77,16 @@ private:
     void ShiftNodeUp(TreeNode *target, TreeNode *node);
     void UpdateMaxSize(TreeNode *node);
 
+    // AVL balancing, keeps the tree height and all operations O(log n)
+    static Size Height(const TreeNode *node) { return node != nullptr ? node->height : 0; }
+    void UpdateNode(TreeNode *node);
+    void Rebalance(TreeNode *node);
+    TreeNode* RotateLeft(TreeNode *node);
+    TreeNode* RotateRight(TreeNode *node);
+
+    static Size CountNodes(const TreeNode *node);
+    static Size MeasureHeight(const TreeNode *node);
+
 
     TreeNode *pRoot;
 };
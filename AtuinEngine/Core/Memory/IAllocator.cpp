@@ -2,23 +2,22 @@
 #include "IAllocator.h"
 #include "Core/Util/Math.h"
 
-#include <cstdlib>
-
 
 namespace Atuin {
 
 
-IAllocator::IAllocator(Size totalMemory, IAllocator *parent) :
+IAllocator::IAllocator(Size totalMemory, IAllocator *parent, const PageBacking &backing) :
     mTotalMemory {totalMemory},
     mUsedMemory {0},
     mMaxUsedMemory {0},
-    pParent {parent}
+    pParent {parent},
+    mBacking {backing}
 {
     assert(mTotalMemory > 0);
 
     if(pParent == nullptr)
     {
-        pBase = malloc(mTotalMemory);
+        pBase = PageMemory::Map(mTotalMemory, mBacking);
     }
     else
     {
@@ -27,11 +26,23 @@ IAllocator::IAllocator(Size totalMemory, IAllocator *parent) :
 }
 
 
+IAllocator::IAllocator(Size totalMemory) :
+    pBase {nullptr},
+    mTotalMemory {totalMemory},
+    mUsedMemory {0},
+    mMaxUsedMemory {0},
+    pParent {nullptr},
+    mBacking {}
+{
+
+}
+
+
 IAllocator::~IAllocator() {
 
     if(pParent == nullptr)
     {
-        free(pBase);
+        PageMemory::Unmap(pBase, mTotalMemory, mBacking);
     }
     else
     {
@@ -3,6 +3,7 @@
 
 
 #include "Core/Util/Types.h"
+#include "PageMemory.h"
 
 #include <assert.h>
 #include <mutex>
@@ -15,7 +16,7 @@ class IAllocator {
 
 public:
 
-    ~IAllocator();
+    virtual ~IAllocator();
 
     Size  TotalMemory()   const { return mTotalMemory;}
     Size  UsedMemory()    const { return mUsedMemory;}
@@ -25,6 +26,9 @@ public:
     virtual void  Free(void *ptr) = 0;
     virtual void  Clear() = 0;
 
+    // Memory accounted for the allocation at ptr including headers and padding, 0 if the allocator does not know it.
+    virtual Size  AllocationSize(const void *ptr) const { (void)ptr; return 0; }
+
     template<typename T, typename... Args>
     T* New(Args&... args);
 
@@ -41,7 +45,10 @@ public:
 protected:
 
     IAllocator() = delete;
-    IAllocator(Size totalMemory, IAllocator *parent);
+    // root allocators without a parent take their memory region from PageMemory as selected by backing
+    IAllocator(Size totalMemory, IAllocator *parent, const PageBacking &backing = PageBacking{});
+    // for allocators that only hand out memory of child allocators and do not own a memory region themselves
+    explicit IAllocator(Size totalMemory);
 
 
     Size GetAlignmentAdjustment(UPtr address, Size alignment);
@@ -59,6 +66,9 @@ protected:
 
     // Poiner to a parent allocator, nullptr by default
     IAllocator *pParent;
+
+    // only used if pParent is nullptr
+    PageBacking mBacking;
 };
 
 
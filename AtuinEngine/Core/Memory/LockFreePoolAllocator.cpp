@@ -0,0 +1,145 @@
+#include "LockFreePoolAllocator.h"
+#include "Core/Util/StringFormat.h"
+
+#include <stdexcept>
+
+
+namespace Atuin {
+
+
+LockFreePoolAllocator::LockFreePoolAllocator(Size numChunks, Size chunkSize, IAllocator *parent) :
+    IAllocator(numChunks * chunkSize, parent),
+    mNumChunks {numChunks},
+    mChunkSize {chunkSize},
+    mBaseAddress {reinterpret_cast<UPtr>(pBase)}
+{
+    assert(mChunkSize >= sizeof(PoolNode));
+    assert(mNumChunks < INDEX_MASK);
+
+    CreatePool();
+}
+
+
+LockFreePoolAllocator::~LockFreePoolAllocator() {
+
+}
+
+
+void* LockFreePoolAllocator::Allocate() {
+
+    return Allocate(mChunkSize, 1);
+}
+
+
+void* LockFreePoolAllocator::Allocate(Size size, U8 alignment) {
+
+    assert(size > 0 && size <= mChunkSize);
+    assert(mChunkSize % alignment == 0);
+
+    void *mem = TryAllocate();
+    if (mem == nullptr)
+    {
+        throw std::overflow_error( FormatStr("Lock-free pool allocator does not have a free chunk for allocation of size %i. Free space %i.", size, mTotalMemory - mUsedMemory));
+    }
+
+    return mem;
+}
+
+
+void* LockFreePoolAllocator::TryAllocate() {
+
+    U64 head = mHead.load(std::memory_order_acquire);
+    while (true)
+    {
+        U32 index = (U32)(head & INDEX_MASK);
+        if (index == 0)
+        {
+            return nullptr;
+        }
+
+        // the chunk might already be handed out by another thread, then next is garbage but the exchange fails
+        U32 next = Node(index)->next.load(std::memory_order_relaxed);
+        U64 newHead = Pack((head >> TAG_SHIFT) + 1, next);
+        if (mHead.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire))
+        {
+            AddUsedMemory(mChunkSize);
+
+            return reinterpret_cast<void*>(Node(index));
+        }
+    }
+}
+
+
+void LockFreePoolAllocator::Free(void *ptr) {
+
+    assert(ptr != nullptr);
+    assert(Owns(ptr));
+
+    U32 index = Index(ptr);
+    PoolNode *node = new (ptr) PoolNode;
+
+    U64 head = mHead.load(std::memory_order_relaxed);
+    U64 newHead;
+    do
+    {
+        node->next.store((U32)(head & INDEX_MASK), std::memory_order_relaxed);
+        newHead = Pack((head >> TAG_SHIFT) + 1, index);
+    } 
+    while (!mHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+
+    SubUsedMemory(mChunkSize);
+}
+
+
+Size LockFreePoolAllocator::AllocationSize(const void *ptr) const {
+
+    (void)ptr;
+    return mChunkSize;
+}
+
+
+void LockFreePoolAllocator::Clear() {
+
+    CreatePool();
+    mUsedMemory = 0;
+}
+
+
+bool LockFreePoolAllocator::Owns(const void *ptr) const {
+
+    UPtr address = reinterpret_cast<UPtr>(ptr);
+
+    return address >= mBaseAddress && address < mBaseAddress + mNumChunks * mChunkSize;
+}
+
+
+void LockFreePoolAllocator::CreatePool() {
+
+    for (U32 i = 1; i <= mNumChunks; i++)
+    {
+        PoolNode *node = new ( reinterpret_cast<void*>(Node(i)) ) PoolNode;
+        node->next.store(i < mNumChunks ? i + 1 : 0, std::memory_order_relaxed);
+    }
+
+    mHead.store(Pack(0, mNumChunks > 0 ? 1 : 0), std::memory_order_release);
+}
+
+
+void LockFreePoolAllocator::AddUsedMemory(Size size) {
+
+    // statistics are updated without the mutex
+    Size used = std::atomic_ref<Size>(mUsedMemory).fetch_add(size, std::memory_order_relaxed) + size;
+
+    std::atomic_ref<Size> maxUsed(mMaxUsedMemory);
+    Size prevMax = maxUsed.load(std::memory_order_relaxed);
+    while (prevMax < used && !maxUsed.compare_exchange_weak(prevMax, used, std::memory_order_relaxed));
+}
+
+
+void LockFreePoolAllocator::SubUsedMemory(Size size) {
+
+    std::atomic_ref<Size>(mUsedMemory).fetch_sub(size, std::memory_order_relaxed);
+}
+
+
+} // Atuin
@@ -0,0 +1,70 @@
+#pragma once
+
+
+#include "IAllocator.h"
+
+#include <atomic>
+
+
+namespace Atuin {
+
+
+/* @brief Pool allocator for fixed size chunks that can be shared between job threads without locking.
+ *        The free list is a lock-free stack of chunk indices, the head packs a 32 bit tag next to the index
+ *        which is incremented on every change, so a head that was popped and pushed again in between fails the exchange (ABA).
+ *        Clear() is the only operation that is not thread safe.
+ */
+class LockFreePoolAllocator : public IAllocator {
+
+
+    struct PoolNode {
+
+        // index + 1 of the next free chunk, 0 marks the end of the list
+        std::atomic<U32> next;
+    };
+
+    static constexpr U64 INDEX_MASK = 0xffffffff;
+    static constexpr U32 TAG_SHIFT = 32;
+
+
+public:
+
+    LockFreePoolAllocator() = delete;
+    LockFreePoolAllocator(Size numChunks, Size chunkSize, IAllocator *parent = nullptr);
+    ~LockFreePoolAllocator();
+
+    void* Allocate();
+    void* Allocate(Size size, U8 alignment) override;
+    void  Free(void *ptr) override;
+    void  Clear() override;
+    Size  AllocationSize(const void *ptr) const override;
+
+    // Same as Allocate() but returns nullptr instead of throwing if the pool is exhausted.
+    void* TryAllocate();
+    bool  Owns(const void *ptr) const;
+
+    Size NumChunks() const { return mNumChunks; }
+    Size ChunkSize() const { return mChunkSize; }
+
+
+private:
+
+    PoolNode* Node(U32 index) const { return reinterpret_cast<PoolNode*>(mBaseAddress + (index - 1) * mChunkSize); }
+    U32 Index(const void *ptr) const { return (U32)((reinterpret_cast<UPtr>(ptr) - mBaseAddress) / mChunkSize) + 1; }
+
+    static U64 Pack(U64 tag, U32 index) { return tag << TAG_SHIFT | index; }
+
+    void CreatePool();
+    void AddUsedMemory(Size size);
+    void SubUsedMemory(Size size);
+
+    Size mNumChunks;
+    Size mChunkSize;
+    UPtr mBaseAddress;
+
+    // tag << 32 | index + 1 of the first free chunk
+    std::atomic<U64> mHead;
+};
+
+
+} // Atuin
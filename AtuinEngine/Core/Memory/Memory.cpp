@@ -11,9 +11,13 @@ MemoryManager* Memory::sMemoryManager =  nullptr;
 
 void* Memory::Allocate(Size size, U8 alignment) {
 
+    if (pAllocator != nullptr)
+    {
+        return pAllocator->Allocate(size, alignment);
+    }
     if (pMemoryManager != nullptr)
     {
-        return pMemoryManager->Allocate(size, alignment);
+        return pMemoryManager->Allocate(size, alignment, mTag);
     }
 
     return malloc(size);
@@ -22,9 +26,13 @@ void* Memory::Allocate(Size size, U8 alignment) {
 
 void Memory::Free(void *ptr) {
 
+    if (pAllocator != nullptr)
+    {
+        return pAllocator->Free(ptr);
+    }
     if(pMemoryManager != nullptr)
     {
-        return pMemoryManager->Free(ptr);
+        return pMemoryManager->Free(ptr, mTag);
     }
 
     return free(ptr);
@@ -32,4 +40,75 @@ void Memory::Free(void *ptr) {
 }
 
 
+IAllocator* Memory::FrameMemory() {
+
+    if (pMemoryManager != nullptr)
+    {
+        return pMemoryManager->FrameMemory();
+    }
+
+    return nullptr;
+}
+
+
+void Memory::BeginFrame() {
+
+    if (pMemoryManager != nullptr)
+    {
+        pMemoryManager->BeginFrame();
+    }
+}
+
+
+MemoryHandle Memory::AllocateRelocatable(Size size, U8 alignment) {
+
+    if (pMemoryManager != nullptr)
+    {
+        return pMemoryManager->AllocateRelocatable(size, alignment, mTag);
+    }
+
+    return MemoryHandle{};
+}
+
+
+void Memory::FreeRelocatable(MemoryHandle handle) {
+
+    if (pMemoryManager != nullptr)
+    {
+        pMemoryManager->FreeRelocatable(handle, mTag);
+    }
+}
+
+
+RelocatableHeap* Memory::RelocatableMemory() {
+
+    if (pMemoryManager != nullptr)
+    {
+        return pMemoryManager->RelocatableMemory();
+    }
+
+    return nullptr;
+}
+
+
+MemoryStats Memory::GetStats(MemoryTag tag) {
+
+    if (pMemoryManager != nullptr)
+    {
+        return pMemoryManager->GetStats(tag);
+    }
+
+    return MemoryStats{0, 0, 0, 0};
+}
+
+
+void Memory::LogStats() {
+
+    if (pMemoryManager != nullptr)
+    {
+        pMemoryManager->LogStats();
+    }
+}
+
+
 } // Atuin
@@ -3,6 +3,7 @@
 
 
 #include "MemoryManager.h"
+#include "MemoryTag.h"
 #include "Core/Util/Types.h"
 
 
@@ -11,6 +12,7 @@ namespace Atuin {
 
 /* @brief Interface to easily use MemoryMananger throughout the code base.
  *        Will default to using malloc, free, new, delete if MemoryManager is  not initialized yet.
+ *        If constructed with an allocator all memory is taken from that allocator instead.
  */
 class Memory {
 
@@ -18,7 +20,10 @@ class Memory {
 
 public:
 
-    Memory() : pMemoryManager {sMemoryManager} {}
+    // default constructed instances use the tag of the innermost MemoryTagScope on this thread
+    Memory() : pMemoryManager {sMemoryManager}, pAllocator {nullptr}, mTag {MemoryTagScope::Current()} {}
+    explicit Memory(MemoryTag tag) : pMemoryManager {sMemoryManager}, pAllocator {nullptr}, mTag {tag} {}
+    explicit Memory(IAllocator *allocator) : pMemoryManager {sMemoryManager}, pAllocator {allocator}, mTag {MemoryTagScope::Current()} {}
 
     void* Allocate(Size size, U8 alignment);
     void  Free(void *ptr);
@@ -35,64 +40,94 @@ public:
     template<typename T>
     void DeleteArray(T *arr, Size size);
 
+    IAllocator* Allocator() const { return pAllocator; }
+    MemoryTag   Tag() const { return mTag; }
+
+    // Linear allocator for data that only lives until the end of the current frame, nullptr if MemoryManager is not initialized.
+    IAllocator* FrameMemory();
+    // Releases the frame memory of the oldest frame, called once at the start of every frame.
+    void BeginFrame();
+
+    // Movable blocks that are compacted over time, access them with RelocatableMemory()->Get(handle).
+    // Invalid handle and nullptr if MemoryManager is not initialized.
+    MemoryHandle AllocateRelocatable(Size size, U8 alignment);
+    void FreeRelocatable(MemoryHandle handle);
+    RelocatableHeap* RelocatableMemory();
+
+    // per tag memory statistics of the MemoryManager, all zero if it is not initialized
+    MemoryStats GetStats(MemoryTag tag);
+    void LogStats();
+
 
 private:
 
     static MemoryManager* sMemoryManager;
     
     MemoryManager* pMemoryManager;
+    IAllocator* pAllocator;
+    MemoryTag mTag;
 };
 
 
 template<typename T, typename... Args>
 T* Memory::New(Args&&... args) {
 
-    if (pMemoryManager != nullptr) 
+    if (pAllocator == nullptr && pMemoryManager == nullptr) 
     {
-        return pMemoryManager->New<T>(std::forward<Args>(args)...);
+        return new T(std::forward<Args>(args)...);
     }
 
-    return new T(std::forward<Args>(args)...);
+    return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
 }
 
 
 template<typename T>
 T* Memory::NewArray(Size size) {
 
-    if (pMemoryManager != nullptr) 
+    if (pAllocator == nullptr && pMemoryManager == nullptr) 
     {
-        return pMemoryManager->NewArray<T>(size);
+        return new T[size];
     }
 
-    return new T[size];
+    T *mem = static_cast<T*>( Allocate(size * sizeof(T), alignof(T)) );
+    for (Size i = 0; i < size; i++)
+    {    
+        new (mem + i) T();
+    }
+
+    return mem;
 }
 
 
 template<typename T>
 void Memory::Delete(T *obj) {
 
-    if (pMemoryManager != nullptr) 
-    {
-        pMemoryManager->Delete(obj);
-    }
-    else
+    if (pAllocator == nullptr && pMemoryManager == nullptr) 
     {
         delete obj;
+        return;
     }
+
+    obj->~T();
+    Free(static_cast<void*>(obj));
 }
 
 
 template<typename T>
 void Memory::DeleteArray(T *arr, Size size) {
 
-    if (pMemoryManager != nullptr) 
+    if (pAllocator == nullptr && pMemoryManager == nullptr) 
     {
-        pMemoryManager->DeleteArray(arr, size);
+        delete[] arr;
+        return;
     }
-    else
+
+    for(Size i=0; i<size; i++)
     {
-        delete[] arr;
+        arr[i].~T();
     }
+
+    Free(static_cast<void*>(arr));
 }
 
     
@@ -1,9 +1,13 @@
 
 #include "MemoryManager.h"
 #include "Memory.h"
+#include "FreeListAllocator.h"
+#include "FreeTreeAllocator.h"
+#include "TLSFAllocator.h"
 #include "EngineLoop.h"
 #include "Core/Config/ConfigManager.h"
 #include "Core/Debug/Logger.h"
+#include "Core/Util/StringFormat.h"
 #include "Scene/Component.h"
 
 
@@ -11,23 +15,83 @@ namespace Atuin {
 
 
 CVar<Size>* MemoryManager::pHeapMemorySize = ConfigManager::RegisterCVar("Memory", "HEAP_MEMORY_SIZE", 512_MB);
+CVar<std::string>* MemoryManager::pHeapAllocator = ConfigManager::RegisterCVar("Memory", "HEAP_ALLOCATOR", std::string("FREE_LIST"));
+CVar<std::string>* MemoryManager::pHeapPageType = ConfigManager::RegisterCVar("Memory", "HEAP_PAGE_TYPE", std::string("MALLOC"));
+CVar<bool>* MemoryManager::pHeapPrefault = ConfigManager::RegisterCVar("Memory", "HEAP_PREFAULT", false);
+CVar<Size>* MemoryManager::pSmallObjectMemorySize = ConfigManager::RegisterCVar("Memory", "SMALL_OBJECT_MEMORY_SIZE", 64_MB);
+CVar<Size>* MemoryManager::pThreadCacheBatchSize = ConfigManager::RegisterCVar("Memory", "THREAD_CACHE_BATCH_SIZE", (Size)32);
+CVar<Size>* MemoryManager::pFrameMemorySize = ConfigManager::RegisterCVar("Memory", "FRAME_MEMORY_SIZE", 16_MB);
+CVar<Size>* MemoryManager::pFrameMemoryBuffers = ConfigManager::RegisterCVar("Memory", "FRAME_MEMORY_BUFFERS", (Size)2);
+CVar<Size>* MemoryManager::pComponentPoolBlockSize = ConfigManager::RegisterCVar("Memory", "COMPONENT_POOL_BLOCK_SIZE", (Size)1024);
+CVar<Size>* MemoryManager::pRelocatableMemorySize = ConfigManager::RegisterCVar("Memory", "RELOCATABLE_MEMORY_SIZE", 64_MB);
+CVar<Size>* MemoryManager::pDefragBytesPerFrame = ConfigManager::RegisterCVar("Memory", "DEFRAG_BYTES_PER_FRAME", 256_KB);
+
+// per tag budgets in bytes in the same order as MemoryTag, 0 means no budget
+CVar<Size>* MemoryManager::pTagBudgets[(Size)MemoryTag::NUM_TAGS] = {
+    ConfigManager::RegisterCVar("Memory Budgets", "GENERAL",    (Size)0),
+    ConfigManager::RegisterCVar("Memory Budgets", "FILES",      (Size)0),
+    ConfigManager::RegisterCVar("Memory Budgets", "GRAPHICS",   (Size)0),
+    ConfigManager::RegisterCVar("Memory Budgets", "GUI",        (Size)0),
+    ConfigManager::RegisterCVar("Memory Budgets", "COLLISION",  (Size)0),
+    ConfigManager::RegisterCVar("Memory Budgets", "AUDIO",      (Size)0),
+    ConfigManager::RegisterCVar("Memory Budgets", "GAMEPLAY",   (Size)0),
+    ConfigManager::RegisterCVar("Memory Budgets", "SCENE",      (Size)0),
+    ConfigManager::RegisterCVar("Memory Budgets", "INPUT",      (Size)0),
+    ConfigManager::RegisterCVar("Memory Budgets", "JOBS",       (Size)0)
+};
 
 
 MemoryManager::MemoryManager() : mLog() {
 
-    pHeapMemory = std::make_unique<FreeListAllocator>(pHeapMemorySize->Get());
+    PageBacking heapBacking{ PageMemory::ToPageType(pHeapPageType->Get()), pHeapPrefault->Get() };
+    if (PageMemory::ToString(heapBacking.type) != pHeapPageType->Get())
+    {
+        mLog.Warning(LogChannel::MEMORY, FormatStr("Unknown heap page type %s, using MALLOC instead.", pHeapPageType->Get().c_str()));
+    }
+
+    pHeapMemory = CreateHeap(pHeapAllocator->Get(), pHeapMemorySize->Get(), heapBacking);
+    if (pSmallObjectMemorySize->Get() > 0)
+    {
+        pSmallObjectMemory = std::make_unique<SizeClassAllocator>(pSmallObjectMemorySize->Get(), pHeapMemory.get(), pThreadCacheBatchSize->Get());
+    }
+    pFrameMemory = std::make_unique<FrameAllocator>(pFrameMemorySize->Get(), std::max(pFrameMemoryBuffers->Get(), (Size)1), pHeapMemory.get());
+    if (pRelocatableMemorySize->Get() > 0)
+    {
+        pRelocatableMemory = std::make_unique<RelocatableHeap>(pRelocatableMemorySize->Get(), pHeapMemory.get());
+    }
+    CreateComponentPools();
 
     Memory::sMemoryManager = this;
     Component::sMemoryManager = this;
 }
 
 
-void* MemoryManager::Allocate(Size size, U8 alignment) {
+MemoryManager::~MemoryManager() {
+
+    // memory allocated from here on falls back to malloc and free
+    Memory::sMemoryManager = nullptr;
+    Component::sMemoryManager = nullptr;
+}
+
+
+void* MemoryManager::Allocate(Size size, U8 alignment, MemoryTag tag) {
+
+    // small allocations are O(1) from their size class, fall back to the heap once a size class is exhausted
+    if (pSmallObjectMemory && SizeClassAllocator::Fits(size, alignment))
+    {
+        void *mem = pSmallObjectMemory->TryAllocate(size, alignment);
+        if (mem != nullptr)
+        {
+            TrackAllocation(tag, pSmallObjectMemory->AllocationSize(mem));
+            return mem;
+        }
+    }
 
     void* mem = nullptr;
     try
     {
         mem = pHeapMemory->Allocate(size, alignment);
+        TrackAllocation(tag, pHeapMemory->AllocationSize(mem));
     }
     catch(const std::exception& e)
     {
@@ -38,10 +102,185 @@ void* MemoryManager::Allocate(Size size, U8 alignment) {
 }
 
 
-void  MemoryManager::Free(void *ptr) {
+std::unique_ptr<IAllocator> MemoryManager::CreateHeap(std::string_view type, Size heapSize, const PageBacking &backing) {
+
+    if (type == "TLSF")
+    {
+        return std::make_unique<TLSFAllocator>(heapSize, nullptr, backing);
+    }
+    if (type == "FREE_TREE")
+    {
+        return std::make_unique<FreeTreeAllocator>(heapSize, nullptr, backing);
+    }
+    if (type != "FREE_LIST")
+    {
+        mLog.Warning(LogChannel::MEMORY, FormatStr("Unknown heap allocator type %s, using FREE_LIST instead.", type.data()));
+    }
+
+    return std::make_unique<FreeListAllocator>(heapSize, nullptr, backing);
+}
+
+
+void MemoryManager::DeleteComponent(Component *component) {
+
+    auto it = mComponentPools.find(component->TypeID());
+    component->~Component();
+
+    if (it != mComponentPools.end())
+    {
+        it->second->Free(component);
+        TrackFree(MemoryTag::SCENE, it->second->ObjectSize());
+        return;
+    }
+
+    Free(component, MemoryTag::SCENE);
+}
+
+
+void MemoryManager::CreateComponentPools() {
+
+    // all component types register themselves during static initialization, before the MemoryManager exists
+    for (auto &[typeId, layout] : Component::sComponentLayouts)
+    {
+        mComponentPools[typeId] = std::make_unique<ObjectPool>(layout.size, layout.alignment, pComponentPoolBlockSize->Get(), pHeapMemory.get());
+    }
+}
+
+
+void* MemoryManager::AllocateComponent(U64 typeId, Size size, U8 alignment) {
+
+    auto it = mComponentPools.find(typeId);
+    if (it != mComponentPools.end())
+    {
+        void *mem = it->second->Allocate();
+        TrackAllocation(MemoryTag::SCENE, it->second->ObjectSize());
+        return mem;
+    }
+
+    return Allocate(size, alignment, MemoryTag::SCENE);
+}
+
+
+MemoryHandle MemoryManager::AllocateRelocatable(Size size, U8 alignment, MemoryTag tag) {
+
+    if (!pRelocatableMemory)
+    {
+        mLog.Error(LogChannel::MEMORY, "Relocatable memory is disabled, RELOCATABLE_MEMORY_SIZE is 0.");
+        return MemoryHandle{};
+    }
+
+    MemoryHandle handle;
+    try
+    {
+        handle = pRelocatableMemory->Allocate(size, alignment);
+        TrackAllocation(tag, size);
+    }
+    catch(const std::exception& e)
+    {
+        mLog.Error(LogChannel::MEMORY, e.what());
+    }
+
+    return handle;
+}
+
+
+void MemoryManager::FreeRelocatable(MemoryHandle handle, MemoryTag tag) {
+
+    if (!pRelocatableMemory || !pRelocatableMemory->IsValid(handle))
+    {
+        return;
+    }
+
+    TrackFree(tag, pRelocatableMemory->AllocationSize(handle));
+    pRelocatableMemory->Free(handle);
+}
+
 
+void MemoryManager::BeginFrame() {
+
+    pFrameMemory->BeginFrame();
+
+    if (pRelocatableMemory)
+    {
+        pRelocatableMemory->Defragment(pDefragBytesPerFrame->Get());
+    }
+}
+
+
+void  MemoryManager::Free(void *ptr, MemoryTag tag) {
+
+    if (pSmallObjectMemory && pSmallObjectMemory->Owns(ptr))
+    {
+        TrackFree(tag, pSmallObjectMemory->AllocationSize(ptr));
+        pSmallObjectMemory->Free(ptr);
+        return;
+    }
+
+    TrackFree(tag, pHeapMemory->AllocationSize(ptr));
     pHeapMemory->Free(ptr);
 }
 
 
+MemoryStats MemoryManager::GetStats(MemoryTag tag) const {
+
+    const TagCounters &counters = mTagCounters[(Size)tag];
+
+    return MemoryStats{
+        counters.usedMemory.load(std::memory_order_relaxed),
+        counters.peakMemory.load(std::memory_order_relaxed),
+        counters.numAllocations.load(std::memory_order_relaxed),
+        pTagBudgets[(Size)tag]->Get()
+    };
+}
+
+
+void MemoryManager::LogStats() const {
+
+    for (Size i = 0; i < (Size)MemoryTag::NUM_TAGS; i++)
+    {
+        MemoryStats stats = GetStats( (MemoryTag)i );
+        if (stats.peakMemory == 0)
+        {
+            continue;
+        }
+
+        mLog.Info(LogChannel::MEMORY, FormatStr("%-10s used %zu bytes in %zu allocations, peak %zu bytes, budget %zu bytes.", 
+            ToString((MemoryTag)i).c_str(), stats.usedMemory, stats.numAllocations, stats.peakMemory, stats.budget));
+    }
+}
+
+
+void MemoryManager::TrackAllocation(MemoryTag tag, Size size) {
+
+    TagCounters &counters = mTagCounters[(Size)tag];
+
+    Size used = counters.usedMemory.fetch_add(size, std::memory_order_relaxed) + size;
+    counters.numAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    Size peak = counters.peakMemory.load(std::memory_order_relaxed);
+    while (peak < used && !counters.peakMemory.compare_exchange_weak(peak, used, std::memory_order_relaxed));
+
+    Size budget = pTagBudgets[(Size)tag]->Get();
+    if (budget > 0 && used > budget && !counters.overBudget.exchange(true, std::memory_order_relaxed))
+    {
+        mLog.Warning(LogChannel::MEMORY, FormatStr("%s memory exceeds its budget, %zu of %zu bytes used.", ToString(tag).c_str(), used, budget));
+    }
+}
+
+
+void MemoryManager::TrackFree(MemoryTag tag, Size size) {
+
+    TagCounters &counters = mTagCounters[(Size)tag];
+
+    Size used = counters.usedMemory.fetch_sub(size, std::memory_order_relaxed) - size;
+    counters.numAllocations.fetch_sub(1, std::memory_order_relaxed);
+
+    Size budget = pTagBudgets[(Size)tag]->Get();
+    if (budget > 0 && used <= budget)
+    {
+        counters.overBudget.store(false, std::memory_order_relaxed);
+    }
+}
+
+
 } // Atuin
\ No newline at end of file
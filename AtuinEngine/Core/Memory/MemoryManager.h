@@ -4,16 +4,37 @@
 
 #include "Core/Config/CVar.h"
 #include "Core/Util/Types.h"
-#include "Core/Memory/FreeListAllocator.h"
+#include "Core/Memory/IAllocator.h"
+#include "Core/Memory/SizeClassAllocator.h"
+#include "Core/Memory/FrameAllocator.h"
+#include "Core/Memory/ObjectPool.h"
+#include "Core/Memory/RelocatableHeap.h"
+#include "Core/Memory/MemoryTag.h"
+#include "Core/Util/StringID.h"
 #include "Core/Debug/Log.h"
 
+#include <atomic>
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 
 namespace Atuin {
 
 
 class EngineLoop;
+class Component;
+
+
+struct MemoryStats {
+
+    Size usedMemory;
+    Size peakMemory;
+    Size numAllocations;
+    // 0 if the tag has no budget
+    Size budget;
+};
+
 
 class MemoryManager {
 
@@ -21,10 +42,11 @@ class MemoryManager {
 public:
 
     MemoryManager();
-    ~MemoryManager() = default;
+    ~MemoryManager();
 
-    void* Allocate(Size size, U8 alignment);
-    void  Free(void *ptr);
+    // the tag an allocation is accounted to must be the same for Allocate() and Free()
+    void* Allocate(Size size, U8 alignment, MemoryTag tag = MemoryTag::GENERAL);
+    void  Free(void *ptr, MemoryTag tag = MemoryTag::GENERAL);
 
     template<typename T, typename... Args>
     T* New(Args&&... args);
@@ -38,20 +60,78 @@ public:
     template<typename T>
     void DeleteArray(T *arr, Size size);
 
+    // components live in one pool per component type, falls back to the heap for unregistered types
+    template<typename T>
+    T* NewComponent();
+    void DeleteComponent(Component *component);
+
+    // movable blocks that are compacted over time, invalid handle if the relocatable heap is disabled or full
+    MemoryHandle AllocateRelocatable(Size size, U8 alignment, MemoryTag tag = MemoryTag::GENERAL);
+    void FreeRelocatable(MemoryHandle handle, MemoryTag tag = MemoryTag::GENERAL);
+    RelocatableHeap* RelocatableMemory() { return pRelocatableMemory.get(); }
+
 
     Size MaxUsedMemory() { return pHeapMemory->MaxUsedMemory(); }
 
+    IAllocator* FrameMemory() { return pFrameMemory.get(); }
+    // releases the oldest frame memory and moves up to DEFRAG_BYTES_PER_FRAME bytes of the relocatable heap
+    void BeginFrame();
+
+    // live per tag statistics, can be polled from any thread
+    MemoryStats GetStats(MemoryTag tag) const;
+    void LogStats() const;
+
 
 private:
 
-    static CVar<Size>* pHeapMemorySize;
+    std::unique_ptr<IAllocator> CreateHeap(std::string_view type, Size heapSize, const PageBacking &backing);
+    void CreateComponentPools();
+    void* AllocateComponent(U64 typeId, Size size, U8 alignment);
 
-    std::unique_ptr<FreeListAllocator> pHeapMemory;
+    void TrackAllocation(MemoryTag tag, Size size);
+    void TrackFree(MemoryTag tag, Size size);
+
+    static CVar<Size>* pHeapMemorySize;
+    static CVar<std::string>* pHeapAllocator;
+    static CVar<std::string>* pHeapPageType;
+    static CVar<bool>* pHeapPrefault;
+    static CVar<Size>* pSmallObjectMemorySize;
+    static CVar<Size>* pThreadCacheBatchSize;
+    static CVar<Size>* pFrameMemorySize;
+    static CVar<Size>* pFrameMemoryBuffers;
+    static CVar<Size>* pComponentPoolBlockSize;
+    static CVar<Size>* pRelocatableMemorySize;
+    static CVar<Size>* pDefragBytesPerFrame;
+    static CVar<Size>* pTagBudgets[(Size)MemoryTag::NUM_TAGS];
+
+
+    struct TagCounters {
+
+        std::atomic<Size> usedMemory = 0;
+        std::atomic<Size> peakMemory = 0;
+        std::atomic<Size> numAllocations = 0;
+        // warn only once each time the budget is exceeded
+        std::atomic<bool> overBudget = false;
+    };
+
+    // FreeListAllocator, FreeTreeAllocator or TLSFAllocator as selected by HEAP_ALLOCATOR
+    std::unique_ptr<IAllocator> pHeapMemory;
+    // serves allocations up to SizeClassAllocator::MAX_CHUNK_SIZE, carved out of the heap
+    // with per thread chunk caches so that worker threads do not contend on a single mutex
+    std::unique_ptr<SizeClassAllocator> pSmallObjectMemory;
+    // transient per frame allocations, one buffer per frame in flight
+    std::unique_ptr<FrameAllocator> pFrameMemory;
+    // handle based blocks for long lived resources with a lot of churn, so that they do not fragment the heap
+    std::unique_ptr<RelocatableHeap> pRelocatableMemory;
+
+    // one pool per registered component type, so that components of the same type are contiguous
+    // only filled in the constructor, so lookups do not need to be synchronized
+    std::unordered_map<U64, std::unique_ptr<ObjectPool>> mComponentPools;
+
+    TagCounters mTagCounters[(Size)MemoryTag::NUM_TAGS];
 
     // TODO ? add entity pool
-    // TODO ? add pool for colliders
     // TODO ? add pools for graphic assets and sound clips
-    // -> everything updated together stays together in memory for cache friendliness ?
 
     Log mLog;
 };
@@ -78,6 +158,14 @@ T* MemoryManager::NewArray(Size size) {
 }
 
 
+template<typename T>
+T* MemoryManager::NewComponent() {
+
+    void *mem = AllocateComponent(SID(T::Type().c_str()), sizeof(T), alignof(T));
+    return new (mem) T();
+}
+
+
 template<typename T>
 void MemoryManager::Delete(T *obj) {
 
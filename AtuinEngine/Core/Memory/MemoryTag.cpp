@@ -0,0 +1,50 @@
+#include "MemoryTag.h"
+
+
+namespace Atuin {
+
+
+thread_local MemoryTag MemoryTagScope::sCurrentTag = MemoryTag::GENERAL;
+
+
+const std::string ToString(MemoryTag tag) {
+
+    switch (tag) {
+
+        case MemoryTag::GENERAL:
+            return "General";
+
+        case MemoryTag::FILES:
+            return "Files";
+
+        case MemoryTag::GRAPHICS:
+            return "Graphics";
+
+        case MemoryTag::GUI:
+            return "GUI";
+
+        case MemoryTag::COLLISION:
+            return "Collision";
+
+        case MemoryTag::AUDIO:
+            return "Audio";
+
+        case MemoryTag::GAMEPLAY:
+            return "Gameplay";
+
+        case MemoryTag::SCENE:
+            return "Scene";
+
+        case MemoryTag::INPUT:
+            return "Input";
+
+        case MemoryTag::JOBS:
+            return "Jobs";
+
+        default:
+            return "Unknown";
+    }
+}
+
+
+} // Atuin
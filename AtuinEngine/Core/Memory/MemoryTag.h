@@ -0,0 +1,58 @@
+#pragma once
+
+
+#include "Core/Util/Types.h"
+
+#include <string>
+
+
+namespace Atuin {
+
+
+// subsystem an allocation is accounted to, follows the naming of LogChannel
+enum class MemoryTag : U8 {
+
+    GENERAL = 0,
+    FILES,
+    GRAPHICS,
+    GUI,
+    COLLISION,
+    AUDIO,
+    GAMEPLAY,
+    SCENE,
+    INPUT,
+    JOBS,
+    NUM_TAGS
+};
+
+const std::string ToString(MemoryTag tag);
+
+
+/* @brief Sets the tag of all Memory instances default constructed on this thread while the scope is alive,
+ *        so containers created by a subsystem are accounted to it without passing the tag around.
+ *        Inside a job the tag belongs to the job's fiber, JobManager swaps it whenever it switches fibers.
+ */
+class MemoryTagScope {
+
+public:
+
+    explicit MemoryTagScope(MemoryTag tag) : mPrevTag {sCurrentTag} { sCurrentTag = tag; }
+    ~MemoryTagScope() { sCurrentTag = mPrevTag; }
+
+    MemoryTagScope(const MemoryTagScope&) = delete;
+    MemoryTagScope& operator= (const MemoryTagScope&) = delete;
+
+    static MemoryTag Current() { return sCurrentTag; }
+    // only for schedulers that switch between fibers on a thread, everything else uses scopes
+    static void SetCurrent(MemoryTag tag) { sCurrentTag = tag; }
+
+
+private:
+
+    static thread_local MemoryTag sCurrentTag;
+
+    MemoryTag mPrevTag;
+};
+
+
+} // Atuin
@@ -0,0 +1,122 @@
+#include "ObjectPool.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+
+namespace Atuin {
+
+
+ObjectPool::ObjectPool(Size objectSize, Size alignment, Size objectsPerBlock, IAllocator *parent) :
+    mObjectsPerBlock {objectsPerBlock},
+    mNumBlocks {0},
+    pBlocks {nullptr},
+    pParent {parent}
+{
+    assert(objectsPerBlock > 0);
+    assert(alignment <= alignof(max_align_t));
+
+    // every chunk has to start at a multiple of the object alignment
+    mChunkSize = (std::max(objectSize, sizeof(void*)) + alignment - 1) & ~(alignment - 1);
+}
+
+
+ObjectPool::~ObjectPool() {
+
+    Block *block = pBlocks.load(std::memory_order_acquire);
+    while (block != nullptr)
+    {
+        Block *next = block->next;
+        block->~Block();
+        pParent != nullptr ? pParent->Free(block) : free(block);
+        block = next;
+    }
+}
+
+
+void* ObjectPool::Allocate() {
+
+    Block *head = pBlocks.load(std::memory_order_acquire);
+    while (true)
+    {
+        for (Block *block = head; block != nullptr; block = block->next)
+        {
+            void *mem = block->allocator.TryAllocate();
+            if (mem != nullptr)
+            {
+                return mem;
+            }
+        }
+
+        head = AddBlock(head);
+    }
+}
+
+
+void ObjectPool::Free(void *ptr) {
+
+    assert(ptr != nullptr);
+
+    Block *block = FindBlock(ptr);
+    assert(block != nullptr);
+
+    block->allocator.Free(ptr);
+}
+
+
+bool ObjectPool::Owns(const void *ptr) const {
+
+    return FindBlock(ptr) != nullptr;
+}
+
+
+Size ObjectPool::UsedMemory() const {
+
+    Size usedMemory = 0;
+    for (Block *block = pBlocks.load(std::memory_order_acquire); block != nullptr; block = block->next)
+    {
+        usedMemory += block->allocator.UsedMemory();
+    }
+
+    return usedMemory;
+}
+
+
+ObjectPool::Block* ObjectPool::FindBlock(const void *ptr) const {
+
+    for (Block *block = pBlocks.load(std::memory_order_acquire); block != nullptr; block = block->next)
+    {
+        if (block->allocator.Owns(ptr))
+        {
+            return block;
+        }
+    }
+
+    return nullptr;
+}
+
+
+ObjectPool::Block* ObjectPool::AddBlock(Block *expectedHead) {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mGrowMutex);
+
+    // another thread might have added a block while waiting for the lock
+    Block *head = pBlocks.load(std::memory_order_acquire);
+    if (head != expectedHead)
+    {
+        return head;
+    }
+
+    void *mem = pParent != nullptr ? pParent->Allocate(sizeof(Block), alignof(Block)) : malloc(sizeof(Block));
+    Block *block = new (mem) Block(mObjectsPerBlock, mChunkSize, pParent);
+    block->next = head;
+
+    pBlocks.store(block, std::memory_order_release);
+    ++mNumBlocks;
+
+    return block;
+}
+
+
+} // Atuin
@@ -0,0 +1,65 @@
+#pragma once
+
+
+#include "IAllocator.h"
+#include "LockFreePoolAllocator.h"
+
+#include <atomic>
+#include <mutex>
+
+
+namespace Atuin {
+
+
+/* @brief Growable pool for objects of one type.
+ *        Objects are stored contiguously in blocks of objectsPerBlock chunks, every block is a LockFreePoolAllocator,
+ *        so allocations and frees from different threads do not lock. A new block is chained in only when all blocks are full.
+ */
+class ObjectPool {
+
+
+    struct Block {
+
+        Block(Size numChunks, Size chunkSize, IAllocator *parent) : allocator(numChunks, chunkSize, parent), next {nullptr} {}
+
+        LockFreePoolAllocator allocator;
+        Block *next;
+    };
+
+
+public:
+
+    ObjectPool() = delete;
+    ObjectPool(Size objectSize, Size alignment, Size objectsPerBlock, IAllocator *parent = nullptr);
+    ~ObjectPool();
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator= (const ObjectPool&) = delete;
+
+    void* Allocate();
+    void  Free(void *ptr);
+    bool  Owns(const void *ptr) const;
+
+    Size ObjectSize() const { return mChunkSize; }
+    Size NumBlocks()  const { return mNumBlocks; }
+    Size UsedMemory() const;
+
+
+private:
+
+    Block* FindBlock(const void *ptr) const;
+    Block* AddBlock(Block *expectedHead);
+
+    Size mChunkSize;
+    Size mObjectsPerBlock;
+    std::atomic<Size> mNumBlocks;
+
+    // newest block first, blocks are never removed before the pool is destroyed
+    std::atomic<Block*> pBlocks;
+    std::mutex mGrowMutex;
+
+    IAllocator *pParent;
+};
+
+
+} // Atuin
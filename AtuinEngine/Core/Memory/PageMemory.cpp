@@ -0,0 +1,177 @@
+
+#include "PageMemory.h"
+
+#include <cstdlib>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+
+namespace Atuin {
+namespace PageMemory {
+
+
+namespace {
+
+
+Size RoundUp(Size size, Size alignment) {
+
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+
+#ifdef __linux__
+
+void* MapHugeTLB(Size size, int populateFlag) {
+
+    void *mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populateFlag, -1, 0);
+
+    return mem != MAP_FAILED ? mem : nullptr;
+}
+
+
+void* MapTransparentHuge(Size size, int populateFlag) {
+
+    // over allocate, so that the region can be trimmed to huge page boundaries
+    Size mappedSize = size + HUGE_PAGE_SIZE;
+    void *mem = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    UPtr address = reinterpret_cast<UPtr>(mem);
+    UPtr alignedAddress = RoundUp(address, HUGE_PAGE_SIZE);
+    if (alignedAddress > address)
+    {
+        munmap(mem, alignedAddress - address);
+    }
+    if (address + mappedSize > alignedAddress + size)
+    {
+        munmap(reinterpret_cast<void*>(alignedAddress + size), address + mappedSize - alignedAddress - size);
+    }
+
+    void *alignedMem = reinterpret_cast<void*>(alignedAddress);
+    madvise(alignedMem, size, MADV_HUGEPAGE);
+
+    // MAP_POPULATE on the initial mapping would fault in 4 KB pages before the advice, so populate afterwards
+    if (populateFlag != 0)
+    {
+        for (Size offset = 0; offset < size; offset += HUGE_PAGE_SIZE)
+        {
+            static_cast<volatile Byte*>(alignedMem)[offset] = 0;
+        }
+    }
+
+    return alignedMem;
+}
+
+#endif
+
+
+} // anonymous
+
+
+void* Map(Size size, const PageBacking &backing) {
+
+#ifdef __linux__
+    int populateFlag = backing.prefault ? MAP_POPULATE : 0;
+
+    switch (backing.type)
+    {
+    case PageType::MALLOC:
+        break;
+
+    case PageType::MMAP:
+    {
+        void *mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | populateFlag, -1, 0);
+        return mem != MAP_FAILED ? mem : nullptr;
+    }
+
+    case PageType::HUGE_PAGES:
+    {
+        // fails if not enough pages are reserved in /proc/sys/vm/nr_hugepages
+        void *mem = MapHugeTLB(RoundUp(size, HUGE_PAGE_SIZE), populateFlag);
+        if (mem != nullptr)
+        {
+            return mem;
+        }
+        return MapTransparentHuge(RoundUp(size, HUGE_PAGE_SIZE), populateFlag);
+    }
+
+    case PageType::TRANSPARENT_HUGE_PAGES:
+        return MapTransparentHuge(RoundUp(size, HUGE_PAGE_SIZE), populateFlag);
+    }
+#endif
+
+    return malloc(size);
+}
+
+
+void Unmap(void *ptr, Size size, const PageBacking &backing) {
+
+    if (ptr == nullptr)
+    {
+        return;
+    }
+
+#ifdef __linux__
+    switch (backing.type)
+    {
+    case PageType::MALLOC:
+        break;
+
+    case PageType::MMAP:
+        munmap(ptr, size);
+        return;
+
+    case PageType::HUGE_PAGES:
+    case PageType::TRANSPARENT_HUGE_PAGES:
+        munmap(ptr, RoundUp(size, HUGE_PAGE_SIZE));
+        return;
+    }
+#else
+    (void)size;
+    (void)backing;
+#endif
+
+    free(ptr);
+}
+
+
+PageType ToPageType(std::string_view name) {
+
+    if (name == "MMAP")
+    {
+        return PageType::MMAP;
+    }
+    if (name == "TRANSPARENT_HUGE_PAGES")
+    {
+        return PageType::TRANSPARENT_HUGE_PAGES;
+    }
+    if (name == "HUGE_PAGES")
+    {
+        return PageType::HUGE_PAGES;
+    }
+
+    return PageType::MALLOC;
+}
+
+
+std::string ToString(PageType type) {
+
+    switch (type)
+    {
+    case PageType::MALLOC:                  return "MALLOC";
+    case PageType::MMAP:                    return "MMAP";
+    case PageType::TRANSPARENT_HUGE_PAGES:  return "TRANSPARENT_HUGE_PAGES";
+    case PageType::HUGE_PAGES:              return "HUGE_PAGES";
+    }
+
+    return "UNKNOWN";
+}
+
+
+} // PageMemory
+} // Atuin
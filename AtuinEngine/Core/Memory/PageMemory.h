@@ -0,0 +1,51 @@
+#pragma once
+
+
+#include "Core/Util/Types.h"
+
+#include <string>
+#include <string_view>
+
+
+namespace Atuin {
+
+
+enum class PageType : U8 {
+
+    // plain malloc, backed by whatever the C runtime picks
+    MALLOC,
+    // anonymous mapping with regular pages
+    MMAP,
+    // anonymous mapping aligned to huge page boundaries and advised for transparent huge pages
+    TRANSPARENT_HUGE_PAGES,
+    // explicit huge pages from the hugetlb pool, falls back to TRANSPARENT_HUGE_PAGES if the pool is empty
+    HUGE_PAGES
+};
+
+
+/* @brief How the memory region of a root allocator is backed.
+ */
+struct PageBacking {
+
+    PageType type = PageType::MALLOC;
+    // fault in all pages up front (MAP_POPULATE), so first touches during a frame do not page fault
+    bool prefault = false;
+};
+
+
+namespace PageMemory {
+
+
+static constexpr Size HUGE_PAGE_SIZE = 2 * MB;
+
+// Memory regions for root allocators. Anything but PageType::MALLOC requires Linux and falls back to malloc elsewhere.
+void* Map(Size size, const PageBacking &backing);
+void  Unmap(void *ptr, Size size, const PageBacking &backing);
+
+// "MALLOC", "MMAP", "TRANSPARENT_HUGE_PAGES" or "HUGE_PAGES", MALLOC for unknown names
+PageType    ToPageType(std::string_view name);
+std::string ToString(PageType type);
+
+
+} // PageMemory
+} // Atuin
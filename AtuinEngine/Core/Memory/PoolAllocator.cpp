@@ -63,6 +63,13 @@ void PoolAllocator::Free(void *ptr) {
 }
 
 
+Size PoolAllocator::AllocationSize(const void *ptr) const {
+
+    (void)ptr;
+    return mChunkSize;
+}
+
+
 void PoolAllocator::Clear() {
 
     // lock mutex
@@ -27,6 +27,7 @@ public:
     void* Allocate(Size size, U8 alignment) override;
     void  Free(void *ptr) override;
     void  Clear() override;
+    Size  AllocationSize(const void *ptr) const override;
 
 
 private:
@@ -0,0 +1,355 @@
+
+#include "RelocatableHeap.h"
+#include "Core/Util/Math.h"
+#include "Core/Util/StringFormat.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+
+namespace Atuin {
+
+
+RelocatableHeap::RelocatableHeap(Size totalMemory, IAllocator *parent) :
+    mTotalMemory {totalMemory},
+    mUsedMemory {0},
+    mMaxUsedMemory {0},
+    mFreeEntry {INVALID_INDEX},
+    mFirstBlock {INVALID_INDEX},
+    mLastBlock {INVALID_INDEX},
+    mCompactBlock {INVALID_INDEX},
+    pParent {parent}
+{
+    assert(mTotalMemory > 0);
+
+    if (pParent == nullptr)
+    {
+        pBase = malloc(mTotalMemory);
+    }
+    else
+    {
+        pBase = pParent->Allocate(mTotalMemory, sizeof(max_align_t));
+    }
+
+    mBaseAddress = reinterpret_cast<UPtr>(pBase);
+    mEndAddress = mBaseAddress + mTotalMemory;
+    mCompactAddress = mBaseAddress;
+}
+
+
+RelocatableHeap::~RelocatableHeap() {
+
+    if (pParent == nullptr)
+    {
+        free(pBase);
+    }
+    else
+    {
+        pParent->Free(pBase);
+    }
+}
+
+
+MemoryHandle RelocatableHeap::Allocate(Size size, U8 alignment) {
+
+    assert(size > 0);
+    assert(alignment > 0);
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    UPtr address = AlignAddress(TopAddress(), alignment);
+    if (address + size > mEndAddress)
+    {
+        // the gaps might be large enough, close them all at once
+        Compact(mTotalMemory);
+
+        address = AlignAddress(TopAddress(), alignment);
+        if (address + size > mEndAddress)
+        {
+            throw std::overflow_error( FormatStr("Relocatable heap does not have a large enough memory region available for allocation of size %i. Free space %i.", size, mTotalMemory - mUsedMemory));
+        }
+    }
+
+    U32 index = AcquireEntry();
+    Entry &entry = mEntries[index];
+    entry.address = address;
+    entry.size = size;
+    entry.pinCount = 0;
+    entry.alignment = alignment;
+    entry.used = true;
+
+    // new blocks are always the topmost ones
+    entry.prev = mLastBlock;
+    entry.next = INVALID_INDEX;
+    if (mLastBlock != INVALID_INDEX)
+    {
+        mEntries[mLastBlock].next = index;
+    }
+    else
+    {
+        mFirstBlock = index;
+    }
+    mLastBlock = index;
+
+    // a block on top of a compact heap does not have to be moved
+    if (mCompactBlock == INVALID_INDEX)
+    {
+        mCompactAddress = address + size;
+    }
+
+    mUsedMemory += size;
+    mMaxUsedMemory = std::max(mMaxUsedMemory, mUsedMemory);
+
+    return MemoryHandle{ index, entry.generation };
+}
+
+
+void RelocatableHeap::Free(MemoryHandle handle) {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    Entry *entry = Find(handle);
+    assert(entry != nullptr);
+    if (entry == nullptr)
+    {
+        return;
+    }
+    assert(entry->pinCount == 0);
+
+    if (entry->prev != INVALID_INDEX)
+    {
+        mEntries[entry->prev].next = entry->next;
+    }
+    else
+    {
+        mFirstBlock = entry->next;
+    }
+    if (entry->next != INVALID_INDEX)
+    {
+        mEntries[entry->next].prev = entry->prev;
+    }
+    else
+    {
+        mLastBlock = entry->prev;
+    }
+
+    // a gap below the compacted range moves the compaction back to it
+    if (handle.index == mCompactBlock || entry->address < mCompactAddress)
+    {
+        mCompactAddress = std::min(mCompactAddress, entry->address);
+        mCompactBlock = entry->next;
+    }
+
+    mUsedMemory -= entry->size;
+
+    entry->used = false;
+    entry->generation = entry->generation == ~0U ? 1 : entry->generation + 1;
+    entry->next = mFreeEntry;
+    mFreeEntry = handle.index;
+}
+
+
+void RelocatableHeap::Clear() {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    // invalidate all handles, entries stay allocated for reuse
+    mFreeEntry = INVALID_INDEX;
+    for (Size i = mEntries.size(); i > 0; i--)
+    {
+        Entry &entry = mEntries[i - 1];
+        if (entry.used)
+        {
+            entry.used = false;
+            entry.generation = entry.generation == ~0U ? 1 : entry.generation + 1;
+        }
+        entry.next = mFreeEntry;
+        mFreeEntry = (U32)(i - 1);
+    }
+
+    mFirstBlock = INVALID_INDEX;
+    mLastBlock = INVALID_INDEX;
+    mCompactAddress = mBaseAddress;
+    mCompactBlock = INVALID_INDEX;
+    mUsedMemory = 0;
+}
+
+
+void* RelocatableHeap::Get(MemoryHandle handle) const {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    const Entry *entry = Find(handle);
+
+    return entry != nullptr ? reinterpret_cast<void*>(entry->address) : nullptr;
+}
+
+
+bool RelocatableHeap::IsValid(MemoryHandle handle) const {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    return Find(handle) != nullptr;
+}
+
+
+Size RelocatableHeap::AllocationSize(MemoryHandle handle) const {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    const Entry *entry = Find(handle);
+
+    return entry != nullptr ? entry->size : 0;
+}
+
+
+void RelocatableHeap::Pin(MemoryHandle handle) {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    Entry *entry = Find(handle);
+    assert(entry != nullptr);
+    if (entry != nullptr)
+    {
+        ++entry->pinCount;
+    }
+}
+
+
+void RelocatableHeap::Unpin(MemoryHandle handle) {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    Entry *entry = Find(handle);
+    assert(entry != nullptr && entry->pinCount > 0);
+    if (entry == nullptr || --entry->pinCount > 0)
+    {
+        return;
+    }
+
+    // compaction skipped over the block while it was pinned, so the gap in front of it is still open
+    if (entry->address < mCompactAddress)
+    {
+        mCompactAddress = entry->prev != INVALID_INDEX ? mEntries[entry->prev].address + mEntries[entry->prev].size : mBaseAddress;
+        mCompactBlock = handle.index;
+    }
+}
+
+
+Size RelocatableHeap::Defragment(Size maxBytes) {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    return Compact(maxBytes);
+}
+
+
+bool RelocatableHeap::IsCompact() const {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    return mCompactBlock == INVALID_INDEX;
+}
+
+
+Size RelocatableHeap::FragmentedMemory() const {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    return TopAddress() - mBaseAddress - mUsedMemory;
+}
+
+
+RelocatableHeap::Entry* RelocatableHeap::Find(MemoryHandle handle) {
+
+    if (handle.index >= mEntries.size())
+    {
+        return nullptr;
+    }
+
+    Entry &entry = mEntries[handle.index];
+
+    return entry.used && entry.generation == handle.generation ? &entry : nullptr;
+}
+
+
+const RelocatableHeap::Entry* RelocatableHeap::Find(MemoryHandle handle) const {
+
+    return const_cast<RelocatableHeap*>(this)->Find(handle);
+}
+
+
+U32 RelocatableHeap::AcquireEntry() {
+
+    if (mFreeEntry != INVALID_INDEX)
+    {
+        U32 index = mFreeEntry;
+        mFreeEntry = mEntries[index].next;
+        return index;
+    }
+
+    Entry entry{};
+    entry.generation = 1;
+    mEntries.push_back(entry);
+
+    return (U32)(mEntries.size() - 1);
+}
+
+
+UPtr RelocatableHeap::TopAddress() const {
+
+    if (mLastBlock == INVALID_INDEX)
+    {
+        return mBaseAddress;
+    }
+
+    return mEntries[mLastBlock].address + mEntries[mLastBlock].size;
+}
+
+
+UPtr RelocatableHeap::AlignAddress(UPtr address, U8 alignment) const {
+
+    assert( Math::IsPowerOfTwo(alignment) );
+
+    return address + Math::ModuloPowerOfTwo(alignment - Math::ModuloPowerOfTwo(address, alignment), alignment);
+}
+
+
+Size RelocatableHeap::Compact(Size maxBytes) {
+
+    Size movedBytes = 0;
+    while (mCompactBlock != INVALID_INDEX && movedBytes < maxBytes)
+    {
+        Entry &entry = mEntries[mCompactBlock];
+
+        // blocks only ever move down, so source and destination may overlap
+        UPtr address = AlignAddress(mCompactAddress, entry.alignment);
+        if (entry.pinCount == 0 && address < entry.address)
+        {
+            std::memmove(reinterpret_cast<void*>(address), reinterpret_cast<void*>(entry.address), entry.size);
+            entry.address = address;
+            movedBytes += entry.size;
+        }
+
+        mCompactAddress = entry.address + entry.size;
+        mCompactBlock = entry.next;
+    }
+
+    return movedBytes;
+}
+
+
+} // Atuin
@@ -0,0 +1,125 @@
+#pragma once
+
+
+#include "IAllocator.h"
+
+#include <mutex>
+#include <vector>
+
+
+namespace Atuin {
+
+
+/* @brief Refers to a block of a RelocatableHeap.
+ *        The generation is bumped whenever a block is freed, so handles to freed blocks are detected instead of aliasing a new block.
+ */
+struct MemoryHandle {
+
+    U32 index = 0;
+    // 0 is never used by a live block, so a default constructed handle is invalid
+    U32 generation = 0;
+
+    bool operator== (const MemoryHandle &other) const { return index == other.index && generation == other.generation; }
+    bool operator!= (const MemoryHandle &other) const { return !(*this == other); }
+};
+
+
+/* @brief Heap of movable blocks that are only accessed through handles.
+ *        Blocks are bumped from the top of the heap, the gaps left by freed blocks are closed by sliding the blocks above them down.
+ *        Defragment() moves a bounded number of bytes per call so compaction can be spread over many frames,
+ *        only if the top of the heap is exhausted a full compaction is done within Allocate().
+ *        Blocks are moved with memmove, so they may only hold trivially relocatable data.
+ *        Pointers returned by Get() stay valid until the next call to Allocate() or Defragment(), unless the block is pinned.
+ */
+class RelocatableHeap {
+
+
+    struct Entry {
+
+        UPtr address;
+        Size size;
+        U32  generation;
+        U32  pinCount;
+        U8   alignment;
+        bool used;
+
+        // address ordered list of live blocks, next links the free entries otherwise
+        U32 prev;
+        U32 next;
+    };
+
+
+    static constexpr U32 INVALID_INDEX = ~0U;
+
+
+public:
+
+    RelocatableHeap() = delete;
+    RelocatableHeap(Size totalMemory, IAllocator *parent = nullptr);
+    ~RelocatableHeap();
+
+    RelocatableHeap(const RelocatableHeap&) = delete;
+    RelocatableHeap& operator= (const RelocatableHeap&) = delete;
+
+    MemoryHandle Allocate(Size size, U8 alignment);
+    void  Free(MemoryHandle handle);
+    void  Clear();
+
+    // nullptr if the handle does not refer to a live block
+    void* Get(MemoryHandle handle) const;
+    bool  IsValid(MemoryHandle handle) const;
+    Size  AllocationSize(MemoryHandle handle) const;
+
+    // pinned blocks are not moved, e.g. while a job works on them
+    void Pin(MemoryHandle handle);
+    void Unpin(MemoryHandle handle);
+
+    // Moves blocks down until at least maxBytes have been moved or the heap is compact, returns the number of bytes moved.
+    // At least one block is moved per call, so a single block larger than maxBytes can not stall compaction.
+    Size Defragment(Size maxBytes);
+    bool IsCompact() const;
+
+    Size TotalMemory()      const { return mTotalMemory; }
+    Size UsedMemory()       const { return mUsedMemory; }
+    Size MaxUsedMemory()    const { return mMaxUsedMemory; }
+    // bytes in gaps between blocks that can only be reused after compaction
+    Size FragmentedMemory() const;
+
+
+private:
+
+    // all expect mMutex to be locked
+    Entry* Find(MemoryHandle handle);
+    const Entry* Find(MemoryHandle handle) const;
+    U32  AcquireEntry();
+    UPtr TopAddress() const;
+    UPtr AlignAddress(UPtr address, U8 alignment) const;
+    Size Compact(Size maxBytes);
+
+
+    void *pBase;
+    UPtr mBaseAddress;
+    UPtr mEndAddress;
+
+    Size mTotalMemory;
+    Size mUsedMemory;
+    Size mMaxUsedMemory;
+
+    // std::vector since Array itself allocates through the memory manager
+    std::vector<Entry> mEntries;
+    U32 mFreeEntry;
+    U32 mFirstBlock;
+    U32 mLastBlock;
+
+    // everything below mCompactAddress is packed, except for gaps in front of pinned blocks,
+    // mCompactBlock is the first block above it and the next one to be moved
+    UPtr mCompactAddress;
+    U32  mCompactBlock;
+
+    mutable std::mutex mMutex;
+
+    IAllocator *pParent;
+};
+
+
+} // Atuin
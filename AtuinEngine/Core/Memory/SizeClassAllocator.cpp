@@ -0,0 +1,326 @@
+
+#include "SizeClassAllocator.h"
+#include "Core/Util/StringFormat.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+
+namespace Atuin {
+
+
+thread_local SizeClassAllocator::ThreadCache SizeClassAllocator::sThreadCache;
+std::mutex SizeClassAllocator::sCacheLock;
+
+
+SizeClassAllocator::ThreadCache::~ThreadCache() {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( sCacheLock);
+
+    // return cached chunks when the thread exits, the owner cannot finish its destructor meanwhile
+    SizeClassAllocator *owner = pOwner.load(std::memory_order_acquire);
+    if (owner != nullptr)
+    {
+        owner->ReleaseCache(*this);
+    }
+}
+
+
+SizeClassAllocator::SizeClassAllocator(Size totalMemory, IAllocator *parent, Size cacheBatchSize) :
+    IAllocator(totalMemory, parent),
+    mCacheBatchSize {cacheBatchSize},
+    pCaches {nullptr}
+{
+    // keep every slab a multiple of the largest chunk size so that all chunks stay aligned
+    mSlabSize = (mTotalMemory / NUM_SIZE_CLASSES) & ~(MAX_CHUNK_SIZE - 1);
+    mBaseAddress = reinterpret_cast<UPtr>(pBase);
+
+    assert(mSlabSize >= MAX_CHUNK_SIZE);
+
+    CreateSizeClasses();
+}
+
+
+SizeClassAllocator::~SizeClassAllocator() {
+
+    // lock mutexes, same order as exiting threads
+    const std::lock_guard<std::mutex> cacheLock( sCacheLock);
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    // detach all thread caches, their chunks die with this allocator
+    for (ThreadCache *cache = pCaches; cache != nullptr; cache = cache->pNext)
+    {
+        cache->pOwner.store(nullptr, std::memory_order_release);
+        std::fill_n(cache->pHeads, NUM_SIZE_CLASSES, nullptr);
+        std::fill_n(cache->mCounts, NUM_SIZE_CLASSES, 0);
+    }
+}
+
+
+void* SizeClassAllocator::Allocate(Size size, U8 alignment) {
+
+    void *mem = TryAllocate(size, alignment);
+    if (mem == nullptr)
+    {
+        throw std::overflow_error( FormatStr("Size class allocator does not have a free chunk for allocation of size %i. Free space %i.", size, mTotalMemory - mUsedMemory));
+    }
+
+    return mem;
+}
+
+
+void* SizeClassAllocator::TryAllocate(Size size, U8 alignment) {
+
+    assert(size > 0);
+    assert(Fits(size, alignment));
+
+    Size classIdx = SizeClassIndex( std::max(size, (Size)alignment) );
+
+    ThreadCache *cache = GetThreadCache();
+    if (cache != nullptr)
+    {
+        if (cache->pHeads[classIdx] == nullptr)
+        {
+            RefillCache(*cache, classIdx);
+        }
+
+        ChunkNode *node = cache->pHeads[classIdx];
+        if (node == nullptr)
+        {
+            return nullptr;
+        }
+
+        cache->pHeads[classIdx] = node->next;
+        --cache->mCounts[classIdx];
+
+        return reinterpret_cast<void*>(node);
+    }
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    return PopChunk(classIdx);
+}
+
+
+void SizeClassAllocator::Free(void *ptr) {
+
+    assert(ptr != nullptr);
+    assert(Owns(ptr));
+
+    Size classIdx = (reinterpret_cast<UPtr>(ptr) - mBaseAddress) / mSlabSize;
+
+    ThreadCache *cache = GetThreadCache();
+    if (cache != nullptr)
+    {
+        cache->pHeads[classIdx] = new (ptr) ChunkNode{cache->pHeads[classIdx]};
+        ++cache->mCounts[classIdx];
+
+        // keep one batch cached and hand the surplus back to the shared slabs
+        if (cache->mCounts[classIdx] >= 2 * mCacheBatchSize)
+        {
+            FlushCache(*cache, classIdx, mCacheBatchSize);
+        }
+
+        return;
+    }
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    PushChunk(ptr, classIdx);
+}
+
+
+void SizeClassAllocator::Clear() {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    for (ThreadCache *cache = pCaches; cache != nullptr; cache = cache->pNext)
+    {
+        std::fill_n(cache->pHeads, NUM_SIZE_CLASSES, nullptr);
+        std::fill_n(cache->mCounts, NUM_SIZE_CLASSES, 0);
+    }
+
+    CreateSizeClasses();
+    mUsedMemory = 0;
+}
+
+
+Size SizeClassAllocator::AllocationSize(const void *ptr) const {
+
+    return ChunkSize( (reinterpret_cast<UPtr>(ptr) - mBaseAddress) / mSlabSize );
+}
+
+
+bool SizeClassAllocator::Owns(const void *ptr) const {
+
+    UPtr address = reinterpret_cast<UPtr>(ptr);
+
+    return address >= mBaseAddress && address < mBaseAddress + NUM_SIZE_CLASSES * mSlabSize;
+}
+
+
+Size SizeClassAllocator::SizeClassIndex(Size size) const {
+
+    // index of the smallest power of two >= size, relative to MIN_CHUNK_SIZE
+    Size roundedSize = std::max(size, MIN_CHUNK_SIZE) - 1;
+
+    return (Size)std::bit_width(roundedSize) - (Size)std::bit_width(MIN_CHUNK_SIZE - 1);
+}
+
+
+void* SizeClassAllocator::PopChunk(Size sizeClass) {
+
+    SizeClass &slab = mSizeClasses[sizeClass];
+    Size chunkSize = ChunkSize(sizeClass);
+
+    void *mem = nullptr;
+    if (slab.pFreeHead != nullptr)
+    {
+        mem = reinterpret_cast<void*>(slab.pFreeHead);
+        slab.pFreeHead = slab.pFreeHead->next;
+    }
+    else if (slab.mTopAddress + chunkSize <= slab.mEndAddress)
+    {
+        mem = reinterpret_cast<void*>(slab.mTopAddress);
+        slab.mTopAddress += chunkSize;
+    }
+    else
+    {
+        return nullptr;
+    }
+
+    // chunks held in thread caches count as used memory
+    mUsedMemory += chunkSize;
+    mMaxUsedMemory = std::max(mMaxUsedMemory, mUsedMemory);
+
+    return mem;
+}
+
+
+void SizeClassAllocator::PushChunk(void *ptr, Size sizeClass) {
+
+    SizeClass &slab = mSizeClasses[sizeClass];
+    slab.pFreeHead = new (ptr) ChunkNode{slab.pFreeHead};
+
+    mUsedMemory -= ChunkSize(sizeClass);
+}
+
+
+SizeClassAllocator::ThreadCache* SizeClassAllocator::GetThreadCache() {
+
+    if (mCacheBatchSize == 0)
+    {
+        return nullptr;
+    }
+
+    ThreadCache *cache = &sThreadCache;
+    SizeClassAllocator *owner = cache->pOwner.load(std::memory_order_relaxed);
+    if (owner == this)
+    {
+        return cache;
+    }
+    if (owner != nullptr)
+    {
+        // thread already caches chunks of another allocator
+        return nullptr;
+    }
+
+    // first use on this thread -> register cache
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    cache->pOwner.store(this, std::memory_order_relaxed);
+    cache->pPrev = nullptr;
+    cache->pNext = pCaches;
+    if (pCaches != nullptr)
+    {
+        pCaches->pPrev = cache;
+    }
+    pCaches = cache;
+
+    return cache;
+}
+
+
+void SizeClassAllocator::RefillCache(ThreadCache &cache, Size sizeClass) {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    for (Size i = 0; i < mCacheBatchSize; i++)
+    {
+        void *mem = PopChunk(sizeClass);
+        if (mem == nullptr)
+        {
+            break;
+        }
+
+        cache.pHeads[sizeClass] = new (mem) ChunkNode{cache.pHeads[sizeClass]};
+        ++cache.mCounts[sizeClass];
+    }
+}
+
+
+void SizeClassAllocator::FlushCache(ThreadCache &cache, Size sizeClass, Size count) {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    for (Size i = 0; i < count && cache.pHeads[sizeClass] != nullptr; i++)
+    {
+        ChunkNode *node = cache.pHeads[sizeClass];
+        cache.pHeads[sizeClass] = node->next;
+        --cache.mCounts[sizeClass];
+
+        PushChunk(node, sizeClass);
+    }
+}
+
+
+void SizeClassAllocator::ReleaseCache(ThreadCache &cache) {
+
+    for (Size i = 0; i < NUM_SIZE_CLASSES; i++)
+    {
+        FlushCache(cache, i, cache.mCounts[i]);
+    }
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    if (cache.pPrev != nullptr)
+    {
+        cache.pPrev->pNext = cache.pNext;
+    }
+    else
+    {
+        pCaches = cache.pNext;
+    }
+    if (cache.pNext != nullptr)
+    {
+        cache.pNext->pPrev = cache.pPrev;
+    }
+
+    cache.pOwner.store(nullptr, std::memory_order_relaxed);
+    cache.pPrev = nullptr;
+    cache.pNext = nullptr;
+}
+
+
+void SizeClassAllocator::CreateSizeClasses() {
+
+    // chunks are carved lazily from the top of each slab, so no memory is touched up front
+    for (Size i = 0; i < NUM_SIZE_CLASSES; i++)
+    {
+        mSizeClasses[i].pFreeHead = nullptr;
+        mSizeClasses[i].mTopAddress = mBaseAddress + i * mSlabSize;
+        mSizeClasses[i].mEndAddress = mSizeClasses[i].mTopAddress + mSlabSize;
+    }
+}
+
+
+} // Atuin
@@ -0,0 +1,109 @@
+#pragma once
+
+
+#include "IAllocator.h"
+
+#include <atomic>
+#include <mutex>
+
+
+namespace Atuin {
+
+
+/* @brief Segregated fit allocator for small objects.
+ *        The memory region is split into one slab per power of two size class from MIN_CHUNK_SIZE to MAX_CHUNK_SIZE.
+ *        Every slab hands out fixed size chunks from an intrusive free list, so Allocate() and Free() are O(1).
+ *        With a cache batch size > 0 every thread keeps a local cache of free chunks per size class, 
+ *        which is refilled from and returned to the shared slabs in batches, so the mutex is only taken once per batch.
+ */
+class SizeClassAllocator : public IAllocator {
+
+
+    struct ChunkNode {
+
+        ChunkNode *next;
+    };
+
+
+    struct SizeClass {
+
+        // chunks that have been freed and can be reused
+        ChunkNode *pFreeHead;
+        // chunks above this address have never been handed out
+        UPtr mTopAddress;
+        UPtr mEndAddress;
+    };
+
+
+public:
+
+    static constexpr Size MIN_CHUNK_SIZE = 16;
+    static constexpr Size MAX_CHUNK_SIZE = 1024;
+    static constexpr Size NUM_SIZE_CLASSES = 7;
+
+    static bool Fits(Size size, U8 alignment) { return size <= MAX_CHUNK_SIZE && alignment <= alignof(max_align_t); }
+
+
+    SizeClassAllocator() = delete;
+    SizeClassAllocator(Size totalMemory, IAllocator *parent = nullptr, Size cacheBatchSize = 0);
+    ~SizeClassAllocator();
+
+
+    void* Allocate(Size size, U8 alignment) override;
+    void  Free(void *ptr) override;
+    void  Clear() override;
+    Size  AllocationSize(const void *ptr) const override;
+
+    // Same as Allocate() but returns nullptr instead of throwing if the size class is exhausted.
+    void* TryAllocate(Size size, U8 alignment);
+    bool  Owns(const void *ptr) const;
+
+
+private:
+
+    struct ThreadCache {
+
+        ~ThreadCache();
+
+        // allocator this cache belongs to, a thread only caches chunks of one allocator at a time
+        // cleared by the allocator's destructor on another thread
+        std::atomic<SizeClassAllocator*> pOwner = nullptr;
+        ChunkNode *pHeads[NUM_SIZE_CLASSES] = {};
+        Size mCounts[NUM_SIZE_CLASSES] = {};
+
+        // intrusive list of all caches registered with the owner
+        ThreadCache *pPrev = nullptr;
+        ThreadCache *pNext = nullptr;
+    };
+
+    static thread_local ThreadCache sThreadCache;
+    // held while a thread exits and while an allocator is destroyed, so exiting threads never release into a dead allocator
+    static std::mutex sCacheLock;
+
+
+    Size SizeClassIndex(Size size) const;
+    Size ChunkSize(Size sizeClass) const { return MIN_CHUNK_SIZE << sizeClass; }
+
+    // both expect mMutex to be locked
+    void* PopChunk(Size sizeClass);
+    void  PushChunk(void *ptr, Size sizeClass);
+
+    ThreadCache* GetThreadCache();
+    void RefillCache(ThreadCache &cache, Size sizeClass);
+    void FlushCache(ThreadCache &cache, Size sizeClass, Size count);
+    void ReleaseCache(ThreadCache &cache);
+
+    void CreateSizeClasses();
+
+
+    Size mSlabSize;
+    UPtr mBaseAddress;
+
+    SizeClass mSizeClasses[NUM_SIZE_CLASSES];
+
+    Size mCacheBatchSize;
+    ThreadCache *pCaches;
+};
+
+
+} // Atuin
@@ -8,8 +8,8 @@
 namespace Atuin {
 
 
-StackAllocator::StackAllocator(Size totalMemory, IAllocator *parent) :
-    IAllocator(totalMemory, parent)
+StackAllocator::StackAllocator(Size totalMemory, IAllocator *parent, const PageBacking &backing) :
+    IAllocator(totalMemory, parent, backing)
 {
     mBaseAddress = reinterpret_cast<UPtr>(pBase);
     mTopAddress = mBaseAddress;
@@ -0,0 +1,301 @@
+
+#include "TLSFAllocator.h"
+#include "Core/Util/Math.h"
+#include "Core/Util/StringFormat.h"
+
+#include <bit>
+#include <stdexcept>
+
+
+namespace Atuin {
+
+
+TLSFAllocator::TLSFAllocator(Size totalMemory, IAllocator *parent, const PageBacking &backing) :
+    IAllocator(totalMemory, parent, backing)
+{
+    // first block header must be aligned, so that all block addresses stay multiples of ALIGNMENT
+    Size adjustment = GetAlignmentAdjustment(reinterpret_cast<UPtr>(pBase), ALIGNMENT);
+    mBaseAddress = reinterpret_cast<UPtr>(pBase) + adjustment;
+    mArenaSize = (mTotalMemory - adjustment) & ~(ALIGNMENT - 1);
+
+    assert(mArenaSize >= MIN_BLOCK_SIZE + BLOCK_HEADER_SIZE);
+    assert(mArenaSize < ((Size)1 << FL_INDEX_MAX));
+
+    CreateBlocks();
+}
+
+
+TLSFAllocator::~TLSFAllocator() {
+
+}
+
+
+void* TLSFAllocator::Allocate(Size size, U8 alignment) {
+
+    assert(size > 0);
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    // block has to be large enough to hold the free list pointers once it is freed again
+    Size payloadSize = std::max( (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1), MIN_BLOCK_SIZE - BLOCK_HEADER_SIZE);
+    Size blockSize = payloadSize + BLOCK_HEADER_SIZE;
+
+    // over aligned allocations need room to split off a leading free block
+    Size searchSize = blockSize;
+    if (alignment > ALIGNMENT)
+    {
+        searchSize += alignment + MIN_BLOCK_SIZE;
+    }
+
+    BlockHeader *block = FindFreeBlock(searchSize);
+    if (block == nullptr)
+    {
+        throw std::overflow_error( FormatStr("TLSF allocator does not have a large enough memory region available for allocation of size %i. Free space %i.", size, mTotalMemory - mUsedMemory));
+    }
+    RemoveFreeBlock(block);
+
+    if (alignment > ALIGNMENT)
+    {
+        Size gap = GetAlignmentAdjustment(reinterpret_cast<UPtr>(block) + BLOCK_HEADER_SIZE, alignment);
+        if (gap > 0 && gap < MIN_BLOCK_SIZE)
+        {
+            gap += alignment;
+        }
+
+        if (gap > 0)
+        {
+            BlockHeader *alignedBlock = SplitBlock(block, gap);
+            SetBlockSize(block, gap, true);
+            InsertFreeBlock(block);
+            block = alignedBlock;
+        }
+    }
+
+    // return the remaining memory to the free lists
+    if (BlockSize(block) >= blockSize + MIN_BLOCK_SIZE)
+    {
+        BlockHeader *remainder = SplitBlock(block, blockSize);
+        SetBlockSize(remainder, BlockSize(remainder), true);
+        InsertFreeBlock(remainder);
+    }
+    SetBlockSize(block, BlockSize(block), false);
+
+    mUsedMemory += BlockSize(block);
+    mMaxUsedMemory = std::max(mMaxUsedMemory, mUsedMemory);
+
+    return reinterpret_cast<void*>(reinterpret_cast<UPtr>(block) + BLOCK_HEADER_SIZE);
+}
+
+
+void TLSFAllocator::Free(void *ptr) {
+
+    assert(ptr != nullptr);
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    BlockHeader *block = reinterpret_cast<BlockHeader*>(reinterpret_cast<UPtr>(ptr) - BLOCK_HEADER_SIZE);
+    assert(!IsFree(block));
+
+    Size freeSize = BlockSize(block);
+    mUsedMemory -= freeSize;
+
+    // merge with physical neighbours
+    BlockHeader *prevBlock = block->prevPhysical;
+    if (prevBlock != nullptr && IsFree(prevBlock))
+    {
+        RemoveFreeBlock(prevBlock);
+        freeSize += BlockSize(prevBlock);
+        block = prevBlock;
+    }
+
+    BlockHeader *nextBlock = reinterpret_cast<BlockHeader*>(reinterpret_cast<UPtr>(block) + freeSize);
+    if (IsFree(nextBlock))
+    {
+        RemoveFreeBlock(nextBlock);
+        freeSize += BlockSize(nextBlock);
+    }
+
+    SetBlockSize(block, freeSize, true);
+    NextPhysical(block)->prevPhysical = block;
+    InsertFreeBlock(block);
+}
+
+
+Size TLSFAllocator::AllocationSize(const void *ptr) const {
+
+    return BlockSize( reinterpret_cast<const BlockHeader*>(reinterpret_cast<UPtr>(ptr) - BLOCK_HEADER_SIZE) );
+}
+
+
+void TLSFAllocator::Clear() {
+
+    // lock mutex
+    const std::lock_guard<std::mutex> lock( mMutex);
+
+    CreateBlocks();
+    mUsedMemory = 0;
+}
+
+
+TLSFAllocator::BlockHeader* TLSFAllocator::NextPhysical(BlockHeader *block) {
+
+    return reinterpret_cast<BlockHeader*>(reinterpret_cast<UPtr>(block) + BlockSize(block));
+}
+
+
+void TLSFAllocator::MappingInsert(Size size, Size &fl, Size &sl) const {
+
+    if (size < SMALL_BLOCK_SIZE)
+    {
+        fl = 0;
+        sl = size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+    }
+    else
+    {
+        Size msb = (Size)std::bit_width(size) - 1;
+        sl = (size >> (msb - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+        fl = msb - (FL_INDEX_SHIFT - 1);
+    }
+}
+
+
+void TLSFAllocator::MappingSearch(Size size, Size &fl, Size &sl) const {
+
+    // round up to the next list, so that every block in it is large enough
+    if (size >= SMALL_BLOCK_SIZE)
+    {
+        Size msb = (Size)std::bit_width(size) - 1;
+        size += ((Size)1 << (msb - SL_INDEX_COUNT_LOG2)) - 1;
+    }
+
+    MappingInsert(size, fl, sl);
+}
+
+
+TLSFAllocator::BlockHeader* TLSFAllocator::FindFreeBlock(Size size) {
+
+    Size fl, sl;
+    MappingSearch(size, fl, sl);
+    if (fl >= FL_INDEX_COUNT)
+    {
+        return nullptr;
+    }
+
+    // first non empty list in the same first level with at least the requested size
+    U32 slMap = mSlBitmaps[fl] & (~0U << sl);
+    if (slMap == 0)
+    {
+        // otherwise the smallest non empty list of the next larger first levels
+        U32 flMap = fl + 1 < FL_INDEX_COUNT ? mFlBitmap & (~0U << (fl + 1)) : 0;
+        if (flMap == 0)
+        {
+            return nullptr;
+        }
+
+        fl = (Size)std::countr_zero(flMap);
+        slMap = mSlBitmaps[fl];
+    }
+    sl = (Size)std::countr_zero(slMap);
+
+    return mFreeLists[fl][sl];
+}
+
+
+void TLSFAllocator::InsertFreeBlock(BlockHeader *block) {
+
+    Size fl, sl;
+    MappingInsert(BlockSize(block), fl, sl);
+
+    BlockHeader *head = mFreeLists[fl][sl];
+    block->nextFree = head;
+    block->prevFree = nullptr;
+    if (head != nullptr)
+    {
+        head->prevFree = block;
+    }
+    mFreeLists[fl][sl] = block;
+
+    mFlBitmap |= 1U << fl;
+    mSlBitmaps[fl] |= 1U << sl;
+}
+
+
+void TLSFAllocator::RemoveFreeBlock(BlockHeader *block) {
+
+    Size fl, sl;
+    MappingInsert(BlockSize(block), fl, sl);
+
+    if (block->prevFree != nullptr)
+    {
+        block->prevFree->nextFree = block->nextFree;
+    }
+    else
+    {
+        mFreeLists[fl][sl] = block->nextFree;
+    }
+    if (block->nextFree != nullptr)
+    {
+        block->nextFree->prevFree = block->prevFree;
+    }
+
+    if (mFreeLists[fl][sl] == nullptr)
+    {
+        mSlBitmaps[fl] &= ~(1U << sl);
+        if (mSlBitmaps[fl] == 0)
+        {
+            mFlBitmap &= ~(1U << fl);
+        }
+    }
+}
+
+
+TLSFAllocator::BlockHeader* TLSFAllocator::SplitBlock(BlockHeader *block, Size size) {
+
+    // block keeps the first size bytes, the returned block holds the rest
+    Size remainingSize = BlockSize(block) - size;
+    BlockHeader *remainder = reinterpret_cast<BlockHeader*>(reinterpret_cast<UPtr>(block) + size);
+
+    SetBlockSize(remainder, remainingSize, false);
+    remainder->prevPhysical = block;
+    NextPhysical(remainder)->prevPhysical = remainder;
+
+    SetBlockSize(block, size, IsFree(block));
+
+    return remainder;
+}
+
+
+void TLSFAllocator::SetBlockSize(BlockHeader *block, Size size, bool isFree) {
+
+    block->size = size | (isFree ? 1 : 0);
+}
+
+
+void TLSFAllocator::CreateBlocks() {
+
+    mFlBitmap = 0;
+    for (Size fl = 0; fl < FL_INDEX_COUNT; fl++)
+    {
+        mSlBitmaps[fl] = 0;
+        for (Size sl = 0; sl < SL_INDEX_COUNT; sl++)
+        {
+            mFreeLists[fl][sl] = nullptr;
+        }
+    }
+
+    // one free block spanning the arena, followed by an empty used block that stops merging at the end
+    BlockHeader *block = reinterpret_cast<BlockHeader*>(mBaseAddress);
+    SetBlockSize(block, mArenaSize - BLOCK_HEADER_SIZE, true);
+    block->prevPhysical = nullptr;
+
+    BlockHeader *sentinel = NextPhysical(block);
+    SetBlockSize(sentinel, 0, false);
+    sentinel->prevPhysical = block;
+
+    InsertFreeBlock(block);
+}
+
+
+} // Atuin
@@ -0,0 +1,85 @@
+#pragma once
+
+
+#include "IAllocator.h"
+
+
+namespace Atuin {
+
+
+/* @brief Two level segregated fit allocator.
+ *        Free blocks are kept in size segregated lists indexed by a first level (power of two) and a second level (linear subdivision),
+ *        two bitmaps allow finding a suitable free list in constant time. Allocate() and Free() are O(1) and
+ *        freed blocks are immediately merged with their physical neighbours.
+ */
+class TLSFAllocator : public IAllocator {
+
+
+    struct BlockHeader {
+
+        // block size including the header, the lowest bit marks a free block
+        Size size;
+        BlockHeader *prevPhysical;
+        // only valid in free blocks, overlaps with the allocated memory otherwise
+        BlockHeader *nextFree;
+        BlockHeader *prevFree;
+    };
+
+
+    static constexpr Size ALIGNMENT_LOG2 = 4;
+    static constexpr Size ALIGNMENT = (Size)1 << ALIGNMENT_LOG2;
+
+    static constexpr Size SL_INDEX_COUNT_LOG2 = 5;
+    static constexpr Size SL_INDEX_COUNT = (Size)1 << SL_INDEX_COUNT_LOG2;
+
+    // blocks smaller than SMALL_BLOCK_SIZE are all kept in first level 0, linearly subdivided
+    static constexpr Size FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + ALIGNMENT_LOG2;
+    static constexpr Size SMALL_BLOCK_SIZE = (Size)1 << FL_INDEX_SHIFT;
+    static constexpr Size FL_INDEX_MAX = 40;
+    static constexpr Size FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+
+    static constexpr Size BLOCK_HEADER_SIZE = 2 * sizeof(Size);
+    static constexpr Size MIN_BLOCK_SIZE = sizeof(BlockHeader);
+
+
+public:
+
+    TLSFAllocator() = delete;
+    TLSFAllocator(Size totalMemory, IAllocator *parent = nullptr, const PageBacking &backing = PageBacking{});
+    ~TLSFAllocator();
+
+
+    void* Allocate(Size size, U8 alignment) override;
+    void  Free(void *ptr) override;
+    void  Clear() override;
+    Size  AllocationSize(const void *ptr) const override;
+
+
+private:
+
+    static Size BlockSize(const BlockHeader *block) { return block->size & ~(Size)1; }
+    static bool IsFree(const BlockHeader *block) { return block->size & 1; }
+    static BlockHeader* NextPhysical(BlockHeader *block);
+
+    void MappingInsert(Size size, Size &fl, Size &sl) const;
+    void MappingSearch(Size size, Size &fl, Size &sl) const;
+    BlockHeader* FindFreeBlock(Size size);
+
+    void InsertFreeBlock(BlockHeader *block);
+    void RemoveFreeBlock(BlockHeader *block);
+    BlockHeader* SplitBlock(BlockHeader *block, Size size);
+    void SetBlockSize(BlockHeader *block, Size size, bool isFree);
+
+    void CreateBlocks();
+
+
+    UPtr mBaseAddress;
+    Size mArenaSize;
+
+    U32 mFlBitmap;
+    U32 mSlBitmaps[FL_INDEX_COUNT];
+    BlockHeader *mFreeLists[FL_INDEX_COUNT][SL_INDEX_COUNT];
+};
+
+
+} // Atuin
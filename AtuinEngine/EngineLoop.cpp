@@ -65,14 +65,22 @@ namespace Atuin {
 
 CVar<U32>* EngineLoop::pMaxFps           = ConfigManager::RegisterCVar("Engine Loop", "MAX_FPS", 30U);
 CVar<U32>* EngineLoop::pMaxSimPerFrame   = ConfigManager::RegisterCVar("Engine Loop", "MAX_SIM_PER_FRAME", 1U);
+CVar<U32>* EngineLoop::pTraceJobFrames   = ConfigManager::RegisterCVar("Engine Loop", "TRACE_JOB_FRAMES", 0U);
+CVar<std::string>* EngineLoop::pTraceJobFile = ConfigManager::RegisterCVar("Engine Loop", "TRACE_JOB_FILE", std::string("Logs/job_trace.json"));
 
 
-EngineLoop::EngineLoop() : mRunning {false}, mLog(), mMemory(), mJobs()  {
+EngineLoop::EngineLoop() : mRunning {false}, mLog(), mMemory(), mJobs(), mFiles()  {
 
-    // engine modules
+    // engine modules, containers created by a module are accounted to its memory tag
     pWindowModule = mMemory.New<WindowModule>();
-    pInputModule  = mMemory.New<InputModule>();
-    pRenderModule = mMemory.New<RenderModule>();
+    {
+        MemoryTagScope tagScope( MemoryTag::INPUT);
+        pInputModule  = mMemory.New<InputModule>();
+    }
+    {
+        MemoryTagScope tagScope( MemoryTag::GRAPHICS);
+        pRenderModule = mMemory.New<RenderModule>();
+    }
 }
 
 
@@ -88,13 +96,24 @@ void EngineLoop::Run() {
 
     StartUp();
 
-    U64 frame = 0;
+    // the first frames are traced if requested, see JobManager::StartTrace()
+    if (pTraceJobFrames->Get() > 0)
+    {
+        mJobs.StartTrace();
+    }
+
+    U64 frame = 0, totalFrames = 0;
     double prevTime = 0, currTime = 0;
     while (mRunning)
     {
         Update();
 
         ++frame;
+        if (++totalFrames == pTraceJobFrames->Get())
+        {
+            mJobs.StopTrace();
+            mFiles.WriteAsync(pTraceJobFile->Get(), mJobs.ExportTrace());
+        }
 
         mGameClock.Update();
         currTime = mGameClock.ElapsedUnscaledTime();
@@ -128,6 +147,8 @@ void EngineLoop::StartUp() {
 
 void EngineLoop::ShutDown() {
 
+    mMemory.LogStats();
+
     pRenderModule->ShutDown();
     pInputModule->ShutDown();
     pWindowModule->ShutDown();
@@ -136,6 +157,11 @@ void EngineLoop::ShutDown() {
 
 void EngineLoop::Update() {
 
+    // transient allocations of the oldest frame in flight are released
+    mMemory.BeginFrame();
+    // coroutines waiting for the next frame continue
+    mJobs.BeginFrame();
+
     mGameClock.Update();
 
     pInputModule->Update();
@@ -5,6 +5,7 @@
 #include "Core/Time/Clock.h"
 #include "Core/Config/CVar.h"
 #include "Core/Debug/Log.h"
+#include "Core/Files/Files.h"
 #include "Core/Jobs/Jobs.h"
 #include "Core/Memory/Memory.h"
 
@@ -45,6 +46,8 @@ private:
     // config variables
     static CVar<U32>* pMaxFps;
     static CVar<U32>* pMaxSimPerFrame;
+    static CVar<U32>* pTraceJobFrames;
+    static CVar<std::string>* pTraceJobFile;
 
     bool mRunning;
     Clock mGameClock;
@@ -52,6 +55,7 @@ private:
     Log mLog;
     Memory mMemory;
     Jobs mJobs;
+    Files mFiles;
 
     // engine modules
     WindowModule*   pWindowModule;
@@ -7,7 +7,7 @@ namespace Atuin {
 
 Component* MeshComponent::Instantiate() {
 
-    return sMemoryManager->New<MeshComponent>();
+    return sMemoryManager->NewComponent<MeshComponent>();
 }
 
 
@@ -22,6 +22,8 @@ RenderModule::~RenderModule() {
 
 void RenderModule::StartUp(GLFWwindow *window) {
 
+    MemoryTagScope tagScope( MemoryTag::GRAPHICS);
+
     pWindow = window;
     mRenderer.StartUp(pWindow);
 
@@ -38,6 +40,8 @@ void RenderModule::ShutDown() {
 
 void RenderModule::Update() {
 
+    MemoryTagScope tagScope( MemoryTag::GRAPHICS);
+
     UpdateObjects();
 
     mRenderer.Update();
@@ -74,6 +74,7 @@ void Renderer::StartUp(GLFWwindow *window) {
 	CreateMeshPass( &mShadowMeshPass, PassType::SHADOW);
 	CreateMeshPass( &mOpaqueMeshPass, PassType::OPAQUE);
 	CreateMeshPass( &mTransparentMeshPass, PassType::TRANSPARENT);
+	CreateFrameGraph();
 
 	CreateDescriptorResources();
 	CreateDescriptorSetLayouts();
@@ -185,28 +186,7 @@ void Renderer::Update() {
 		mMeshesDirty = false;
 	}
 
-	auto meshUpdates = mJobs.CreateJob( [](void*){}, nullptr);
-	auto shadowUpdate = mJobs.CreateJob( [&](void *data){
-		UpdateMeshPass( (MeshPass*)data);
-	}, &mShadowMeshPass, meshUpdates);
-	auto opaqueUpdate = mJobs.CreateJob( [&](void *data){
-		UpdateMeshPass( (MeshPass*)data);
-	}, &mOpaqueMeshPass, meshUpdates);
-	auto transparentUpdate = mJobs.CreateJob( [&](void *data){
-		UpdateMeshPass( (MeshPass*)data);
-	}, &mTransparentMeshPass, meshUpdates);
-
-	mJobs.Run( shadowUpdate);
-	mJobs.Run( opaqueUpdate);
-	mJobs.Run( transparentUpdate);
-	mJobs.Run( meshUpdates);
-
-	mJobs.Wait( meshUpdates);
-
-	// UpdateMeshPass( &mShadowMeshPass);
-	// UpdateMeshPass( &mOpaqueMeshPass);
-	// UpdateMeshPass( &mTransparentMeshPass);
-
+	// mesh passes are updated in the frame graph in DrawFrame()
 	DrawFrame();
 }
 
@@ -625,6 +605,31 @@ void Renderer::CreateMaterial( std::string_view materialName) {
 
 	// get images and build descriptor sets
 	auto &textures = materialJson.At( "textures").GetList();
+
+	// new images are read and decoded in parallel, only the upload in CreateTexture() stays on this thread
+	Array<Coroutine<ImageData>> imageLoads( textures.GetSize());
+	Array<std::string> imagePaths( textures.GetSize());
+	for ( auto &texture : textures)
+	{
+		std::string imageName = texture.At( "image").ToString();
+		std::string imagePath = mResourceDir + imageName;
+		bool loading = false;
+		for ( auto &path : imagePaths)
+		{
+			loading = loading || path == imagePath;
+		}
+		if ( !loading && mTextures.Find( SID( imageName.c_str())) == mTextures.End() && !pResources->HasImage( imagePath))
+		{
+			imageLoads.EmplaceBack( pResources->LoadImageAsync( imagePath));
+			imageLoads.Back().Start( JobPriority::HIGH);
+			imagePaths.PushBack( imagePath);
+		}
+	}
+	for ( Size i = 0; i < imageLoads.GetSize(); i++)
+	{
+		pResources->AddImage( imagePaths[i], imageLoads[i].Get());
+	}
+
 	DescriptorSetBuilder builder( pCore->Device(), pDescriptorSetAllocator, pDescriptorLayoutCache);
 	U32 binding = 0;
 	Array<vk::DescriptorImageInfo> imageInfos;
@@ -1062,7 +1067,7 @@ void Renderer::UpdateMeshPass( MeshPass *pass) {
 		// mLog.Info( LogChannel::GRAPHICS, FormatStr( "Deleting %d objects from mesh pass %d.", pass->deleteObjectIndices.GetSize(), (U8)pass->passType));
 
 		// render batches of deleted objects
-		Array<RenderBatch> deleteBatches;
+		Array<RenderBatch> deleteBatches( mMemory.FrameMemory());
 		deleteBatches.Reserve( pass->deleteObjectIndices.GetSize());
 		for ( U32 idx : pass->deleteObjectIndices)
 		{
@@ -1091,7 +1096,7 @@ void Renderer::UpdateMeshPass( MeshPass *pass) {
 	{
 		// mLog.Info( LogChannel::GRAPHICS, FormatStr( "Adding %d objects to mesh pass %d.", pass->unbatchedIndices.GetSize(), (U8)pass->passType));
 
-		Array<RenderBatch> newBatches;
+		Array<RenderBatch> newBatches( mMemory.FrameMemory());
 		newBatches.Reserve( pass->unbatchedIndices.GetSize());
 		for ( U32 objIdx : pass->unbatchedIndices)
 		{
@@ -1120,26 +1125,20 @@ void Renderer::UpdateMeshPass( MeshPass *pass) {
 		pass->unbatchedIndices.Clear();
 
 		// combine new batches with renderBatches and sort
+		// new batches live in frame memory, so they are always copied instead of moved into renderBatches
 		std::sort( newBatches.Begin(), newBatches.End());
-		if ( pass->renderBatches.IsEmpty())
+		Size oldSize = pass->renderBatches.GetSize();
+		Size newSize = oldSize + newBatches.GetSize();
+		pass->renderBatches.Reserve( newSize);
+		for ( auto &batch : newBatches)
 		{
-			pass->renderBatches = std::move( newBatches);
+			pass->renderBatches.PushBack( batch);
 		}
-		else 
-		{
-			Size oldSize = pass->renderBatches.GetSize();
-			Size newSize = oldSize + newBatches.GetSize();
-			pass->renderBatches.Reserve( newSize);
-			for ( auto &batch : newBatches)
-			{
-				pass->renderBatches.PushBack( batch);
-			}
 
-			auto begin = pass->renderBatches.Begin();
-			auto middle = begin + oldSize;
-			auto end = begin + newSize;
-			std::inplace_merge( begin, middle, end);
-		}
+		auto begin = pass->renderBatches.Begin();
+		auto middle = begin + oldSize;
+		auto end = begin + newSize;
+		std::inplace_merge( begin, middle, end);
 
 		pass->hasChanged = true;
 	}
@@ -1275,31 +1274,20 @@ void Renderer::UpdateMeshPassBatchBuffer( AsyncBufferCopyData *data) {
 	}
 	IndirectData *indirectData = (IndirectData*)memPtr;
 
-	U32 N = (U32)pass->indirectBatches.GetSize(), k = 20, M = N / k;
-	auto copies = mJobs.CreateJob( [](void*){}, nullptr);
-	for ( U32 i = 0; i <= M; i++)
-	{
-		auto copy = mJobs.CreateJob( [&, i](void*){
+	mJobs.ParallelFor( 0, pass->indirectBatches.GetSize(), [&](Size j){
 
-			for ( U32 j = i * k; j < (i + 1) * k  &&  j < N; j++)
-			{
-				IndirectBatch batch = pass->indirectBatches[j];
-				Mesh &mesh = mMeshes[ mRenderObjects[batch.objectIdx].meshId ];
-
-				indirectData[j].batchIdx = j;
-				indirectData[j].objectIdx = batch.objectIdx;
-				indirectData[j].drawIndirectCmd
-					.setVertexOffset( mesh.firstVertex )
-					.setFirstIndex( mesh.firstIndex )
-					.setIndexCount( mesh.indexCount )
-					.setFirstInstance( batch.first )
-					.setInstanceCount( 0 );
-			}
-		}, nullptr, copies);
-		mJobs.Run( copy);
-	}
-	mJobs.Run( copies);
-	mJobs.Wait( copies);
+		IndirectBatch batch = pass->indirectBatches[j];
+		Mesh &mesh = mMeshes[ mRenderObjects[batch.objectIdx].meshId ];
+
+		indirectData[j].batchIdx = (U32)j;
+		indirectData[j].objectIdx = batch.objectIdx;
+		indirectData[j].drawIndirectCmd
+			.setVertexOffset( mesh.firstVertex )
+			.setFirstIndex( mesh.firstIndex )
+			.setIndexCount( mesh.indexCount )
+			.setFirstInstance( batch.first )
+			.setInstanceCount( 0 );
+	}, 0, JobPriority::HIGH);
 
 	pCore->Device().unmapMemory( data->stagingBuffer.bufferMemory);
 
@@ -1334,22 +1322,15 @@ void Renderer::UpdateMeshPassInstanceBuffer( AsyncBufferCopyData *data) {
 	}
 	InstanceData *instanceData = (InstanceData*)memPtr;
 
-	auto copies = mJobs.CreateJob( [](void*){}, nullptr);
-	for ( U32 batchIdx = 0; batchIdx < pass->indirectBatches.GetSize(); batchIdx++)
-	{
-		auto copy = mJobs.CreateJob( [&, batchIdx](void*){
+	mJobs.ParallelFor( 0, pass->indirectBatches.GetSize(), [&](Size batchIdx){
 
-			IndirectBatch batch = pass->indirectBatches[ batchIdx];
-			for ( U32 i = 0; i < batch.count; i++)
-			{
-				instanceData[ batch.first + i].batchIdx = batchIdx;
-				instanceData[ batch.first + i].objectIdx = pass->renderBatches[ batch.first + i].objectIdx;
-			}
-		}, nullptr, copies);
-		mJobs.Run( copy);
-	}
-	mJobs.Run( copies);
-	mJobs.Wait( copies);
+		IndirectBatch batch = pass->indirectBatches[ batchIdx];
+		for ( U32 i = 0; i < batch.count; i++)
+		{
+			instanceData[ batch.first + i].batchIdx = (U32)batchIdx;
+			instanceData[ batch.first + i].objectIdx = pass->renderBatches[ batch.first + i].objectIdx;
+		}
+	}, 0, JobPriority::HIGH);
 
 	pCore->Device().unmapMemory( data->stagingBuffer.bufferMemory);
 
@@ -1395,31 +1376,19 @@ void Renderer::UpdateObjectBuffer( AsyncBufferCopyData *data) {
 	}
 	ObjectData *objData = (ObjectData*)memPtr;
 
-	// launch M + 1 jobs performing at most k copy operatins
-	U32 N = (U32)mDirtyObjectIndices.GetSize(), k = 20, M = N / k;
+	Size N = mDirtyObjectIndices.GetSize();
 	data->bufferCopies.Resize( N);
-	auto copies = mJobs.CreateJob( [](void*){}, nullptr);
-	for ( U32 i = 0; i <= M; i++)
-	{
-		auto copy = mJobs.CreateJob( [&, i](void*){
-			
-			for ( U32 j = i * k; j < (i + 1) * k  &&  j < N; j++)
-			{
-				objData[j].transform = *mRenderObjects[ mDirtyObjectIndices[j]].transform;
-				objData[j].sphereBounds = *mRenderObjects[ mDirtyObjectIndices[j]].sphereBounds;
-				mRenderObjects[j].updated = false;
-
-				data->bufferCopies[j]
-					.setSrcOffset( j * sizeof( ObjectData) )
-					.setDstOffset( mDirtyObjectIndices[j] * sizeof( ObjectData) )
-					.setSize( sizeof( ObjectData) );
-			}
-		}, nullptr, copies);
-		mJobs.Run( copy);
-	}
+	mJobs.ParallelFor( 0, N, [&](Size j){
+
+		objData[j].transform = *mRenderObjects[ mDirtyObjectIndices[j]].transform;
+		objData[j].sphereBounds = *mRenderObjects[ mDirtyObjectIndices[j]].sphereBounds;
+		mRenderObjects[j].updated = false;
 
-	mJobs.Run( copies);
-	mJobs.Wait( copies);
+		data->bufferCopies[j]
+			.setSrcOffset( j * sizeof( ObjectData) )
+			.setDstOffset( mDirtyObjectIndices[j] * sizeof( ObjectData) )
+			.setSize( sizeof( ObjectData) );
+	}, 0, JobPriority::HIGH);
 	
 	pCore->Device().unmapMemory( data->stagingBuffer.bufferMemory);
 
@@ -1651,6 +1620,47 @@ void Renderer::CreateMeshPass( MeshPass *pass, PassType type) {
 }
 
 
+void Renderer::CreateFrameGraph() {
+
+	// scene and object data do not depend on any other update
+	mFrameGraph.AddNode( [this](void*){
+		UpdateCameraData();
+		UpdateSceneData();
+		UpdateShadowCascade();
+	}, nullptr, JobPriority::HIGH);
+
+	mFrameGraph.AddNode( [this](void *data){
+		UpdateObjectBuffer( (AsyncBufferCopyData*)data);
+	}, &mObjectUpdateData, JobPriority::HIGH);
+
+	// the buffers of a pass are uploaded as soon as its batches are rebuilt, independent of the other passes
+	MeshPass *passes[] = { &mShadowMeshPass, &mOpaqueMeshPass, &mTransparentMeshPass };
+	AsyncBufferCopyData *batchUpdateData[] = { &mShadowBatchUpdateData, &mOpaqueBatchUpdateData, &mTransparentBatchUpdateData };
+	AsyncBufferCopyData *instanceUpdateData[] = { &mShadowInstanceUpdateData, &mOpaqueInstanceUpdateData, &mTransparentInstanceUpdateData };
+
+	for ( Size i = 0; i < 3; i++)
+	{
+		batchUpdateData[i]->pass = passes[i];
+		instanceUpdateData[i]->pass = passes[i];
+
+		TaskNodeID passUpdate = mFrameGraph.AddNode( [this](void *data){
+			UpdateMeshPass( (MeshPass*)data);
+		}, passes[i], JobPriority::HIGH);
+
+		TaskNodeID batchUpdate = mFrameGraph.AddNode( [this](void *data){
+			UpdateMeshPassBatchBuffer( (AsyncBufferCopyData*)data);
+		}, batchUpdateData[i], JobPriority::HIGH);
+
+		TaskNodeID instanceUpdate = mFrameGraph.AddNode( [this](void *data){
+			UpdateMeshPassInstanceBuffer( (AsyncBufferCopyData*)data);
+		}, instanceUpdateData[i], JobPriority::HIGH);
+
+		mFrameGraph.AddEdge( passUpdate, batchUpdate);
+		mFrameGraph.AddEdge( passUpdate, instanceUpdate);
+	}
+}
+
+
 void Renderer::CreateDescriptorResources() {
 
 	// camera data
@@ -2088,6 +2098,15 @@ void Renderer::UpdateShadowCascade() {
 }
 
 
+void Renderer::ResetBufferUpdate( AsyncBufferCopyData *data) {
+
+	// buffer copies are taken from the current frame memory, the pass stays the same every frame
+	MeshPass *pass = data->pass;
+	*data = AsyncBufferCopyData( mMemory.FrameMemory());
+	data->pass = pass;
+}
+
+
 void Renderer::FinishBufferUpdate( vk::CommandBuffer cmd, AsyncBufferCopyData *data) {
 
 
@@ -2169,75 +2188,23 @@ void Renderer::DrawFrame() {
 	// buffer updates
 	mPreCullBarriers.Clear();
 
-	auto preCullUpdates = mJobs.CreateJob( [](void*){}, nullptr);
-
-	auto sceneUpdate =  mJobs.CreateJob( [&](void*){
-		UpdateCameraData();
-		UpdateSceneData();
-		UpdateShadowCascade();
-	}, nullptr, preCullUpdates);
-	mJobs.Run( sceneUpdate);
+	AsyncBufferCopyData *updateData[] = {
+		&mObjectUpdateData,
+		&mShadowBatchUpdateData, &mShadowInstanceUpdateData,
+		&mOpaqueBatchUpdateData, &mOpaqueInstanceUpdateData,
+		&mTransparentBatchUpdateData, &mTransparentInstanceUpdateData
+	};
+	for ( AsyncBufferCopyData *data : updateData)
+	{
+		ResetBufferUpdate( data);
+	}
 
+	mFrameGraph.Execute();
 
-	AsyncBufferCopyData objectUpdateData;
-	auto objectUpdate =  mJobs.CreateJob( [&](void* data){
-		UpdateObjectBuffer( (AsyncBufferCopyData*)data);
-	}, &objectUpdateData, preCullUpdates);
-	mJobs.Run( objectUpdate);
-
-
-	AsyncBufferCopyData shadowBatchUpdateData;
-	shadowBatchUpdateData.pass = &mShadowMeshPass;
-	auto shadowBatchUpdate =  mJobs.CreateJob( [&](void *data){
-		UpdateMeshPassBatchBuffer( (AsyncBufferCopyData*)data);
-	}, &shadowBatchUpdateData, preCullUpdates);
-	mJobs.Run( shadowBatchUpdate);
-
-	AsyncBufferCopyData shadowInstanceUpdateData;
-	shadowInstanceUpdateData.pass = &mShadowMeshPass;
-	auto shadowInstanceUpdate =  mJobs.CreateJob( [&](void *data){
-		UpdateMeshPassInstanceBuffer( (AsyncBufferCopyData*)data);
-	}, &shadowInstanceUpdateData, preCullUpdates);
-	mJobs.Run( shadowInstanceUpdate);
-
-	AsyncBufferCopyData opaqueBatchUpdateData;
-	opaqueBatchUpdateData.pass = &mOpaqueMeshPass;
-	auto opaqueBatchUpdate =  mJobs.CreateJob( [&](void *data){
-		UpdateMeshPassBatchBuffer( (AsyncBufferCopyData*)data);
-	}, &opaqueBatchUpdateData, preCullUpdates);
-	mJobs.Run( opaqueBatchUpdate);
-
-	AsyncBufferCopyData opaqueInstanceUpdateData;
-	opaqueInstanceUpdateData.pass = &mOpaqueMeshPass;
-	auto opaqueInstanceUpdate =  mJobs.CreateJob( [&](void *data){
-		UpdateMeshPassInstanceBuffer( (AsyncBufferCopyData*)data);
-	}, &opaqueInstanceUpdateData, preCullUpdates);
-	mJobs.Run( opaqueInstanceUpdate);
-
-	AsyncBufferCopyData transparentBatchUpdateData;
-	transparentBatchUpdateData.pass = &mTransparentMeshPass;
-	auto transparentBatchUpdate =  mJobs.CreateJob( [&](void *data){
-		UpdateMeshPassBatchBuffer( (AsyncBufferCopyData*)data);
-	}, &transparentBatchUpdateData, preCullUpdates);
-	mJobs.Run( transparentBatchUpdate);
-
-	AsyncBufferCopyData transparentInstanceUpdateData;
-	transparentInstanceUpdateData.pass = &mTransparentMeshPass;
-	auto transparentInstanceUpdate =  mJobs.CreateJob( [&](void *data){
-		UpdateMeshPassInstanceBuffer( (AsyncBufferCopyData*)data);
-	}, &transparentInstanceUpdateData, preCullUpdates);
-	mJobs.Run( transparentInstanceUpdate);
-
-	mJobs.Run( preCullUpdates);
-	mJobs.Wait( preCullUpdates);
-
-	FinishBufferUpdate( cmd, &objectUpdateData);
-	FinishBufferUpdate( cmd, &shadowBatchUpdateData);
-	FinishBufferUpdate( cmd, &shadowInstanceUpdateData);
-	FinishBufferUpdate( cmd, &opaqueBatchUpdateData);
-	FinishBufferUpdate( cmd, &opaqueInstanceUpdateData);
-	FinishBufferUpdate( cmd, &transparentBatchUpdateData);
-	FinishBufferUpdate( cmd, &transparentInstanceUpdateData);
+	for ( AsyncBufferCopyData *data : updateData)
+	{
+		FinishBufferUpdate( cmd, data);
+	}
 
 
 	cmd.pipelineBarrier( 
@@ -16,6 +16,7 @@
 #include "Core/Debug/Log.h"
 #include "Core/Memory/Memory.h"
 #include "Core/Jobs/Jobs.h"
+#include "Core/Jobs/TaskGraph.h"
 #include "Core/Files/Files.h"
 #include "Core/DataStructures/Array.h"
 #include "Core/DataStructures/Map.h"
@@ -146,6 +147,9 @@ struct CullDebugData {
 
 struct AsyncBufferCopyData {
 
+    // buffer copies only live until they are recorded, so they are usually taken from the frame memory
+    AsyncBufferCopyData( IAllocator *allocator = nullptr) : bufferCopies( allocator) {}
+
     Array<vk::BufferCopy> bufferCopies;
     Buffer stagingBuffer;
     vk::Buffer targetBuffer;
@@ -188,6 +192,7 @@ private:
     void RecreateSwapchain();
     void CreateDefaultPipelineBuilder();
     void CreateMeshPass( MeshPass *pass, PassType type);
+    void CreateFrameGraph();
 
     // resources
     void RegisterMeshObject( MeshObject *object);
@@ -238,6 +243,7 @@ private:
     void CreateSamplers();
     void CreatePipelines();
 
+    void ResetBufferUpdate( AsyncBufferCopyData *updateData);
     void FinishBufferUpdate( vk::CommandBuffer cmd, AsyncBufferCopyData *updateData);
 
 
@@ -341,6 +347,16 @@ private:
     MeshPass mOpaqueMeshPass;
     MeshPass mTransparentMeshPass;
 
+    // mesh pass and buffer updates of a frame, built once in CreateFrameGraph()
+    TaskGraph mFrameGraph;
+    AsyncBufferCopyData mObjectUpdateData;
+    AsyncBufferCopyData mShadowBatchUpdateData;
+    AsyncBufferCopyData mShadowInstanceUpdateData;
+    AsyncBufferCopyData mOpaqueBatchUpdateData;
+    AsyncBufferCopyData mOpaqueInstanceUpdateData;
+    AsyncBufferCopyData mTransparentBatchUpdateData;
+    AsyncBufferCopyData mTransparentInstanceUpdateData;
+
     // TODO use dynamic uniform buffer or move into FrameResource ?
     Buffer mCameraBuffer;
     Buffer mSceneBuffer;
@@ -1,5 +1,6 @@
 
 #include "ResourceManager.h"
+#include "Core/Files/Files.h"
 #include "Core/Util/StringID.h"
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -11,6 +12,30 @@
 namespace Atuin {
 
 
+namespace {
+
+// takes ownership of the pixels returned by stbi_load() or stbi_load_from_memory(), which are always converted to RGBA
+ImageData TakePixels( stbi_uc *pixels, int width, int height) {
+
+    if (!pixels)
+    {
+        throw std::runtime_error("Failed to load texture image!");
+    }
+    Size imageSize = width * height * 4;
+
+    ImageData imageData;
+    imageData.width = (U32)width;
+    imageData.height = (U32)height;
+    imageData.pixelData.Resize( imageSize);
+    memcpy( imageData.pixelData.Data(), pixels, imageSize);
+    stbi_image_free( pixels);
+
+    return imageData;
+}
+
+} // anonymous
+
+
 MeshData* ResourceManager::GetMesh( std::string_view meshPath) {
 
     U64 meshId = SID( meshPath.data());
@@ -35,6 +60,36 @@ ImageData* ResourceManager::GetImage( std::string_view imagePath) {
 }
 
 
+bool ResourceManager::HasImage( std::string_view imagePath) {
+
+    return mImageResources.Find( SID( imagePath.data())) != mImageResources.End();
+}
+
+
+Coroutine<ImageData> ResourceManager::LoadImageAsync( std::string imagePath) {
+
+    Array<char> content;
+    co_await Files().AwaitRead( imagePath, content, std::ios::in | std::ios::binary);
+
+    // decode image data on the worker that continues after the read
+    int width, height, channels;
+    stbi_uc *pixels = stbi_load_from_memory( (const stbi_uc*)content.Data(), (int)content.GetSize(), &width, &height, &channels, STBI_rgb_alpha);
+
+    co_return TakePixels( pixels, width, height);
+}
+
+
+ImageData* ResourceManager::AddImage( std::string_view imagePath, ImageData &&imageData) {
+
+    U64 imageId = SID( imagePath.data());
+    Resource<ImageData> &image = mImageResources[ imageId];
+    image.resourcePath = imagePath;
+    image.resource = std::move( imageData);
+
+    return &image.resource;
+}
+
+
 void ResourceManager::LoadMesh( std::string_view meshPath) {
 
     // load mesh data from file
@@ -116,21 +171,10 @@ void ResourceManager::LoadMesh( std::string_view meshPath) {
 void ResourceManager::LoadImage( std::string_view imagePath) {
 
     // load image data from file
-	int width, height, channels;
-	stbi_uc *pixels = stbi_load( imagePath.data(), &width, &height, &channels, STBI_rgb_alpha);
-	if (!pixels)
-	{
-		throw std::runtime_error("Failed to load texture image!");
-	}
-    Size imageSize = width * height * 4;
+    int width, height, channels;
+    stbi_uc *pixels = stbi_load( imagePath.data(), &width, &height, &channels, STBI_rgb_alpha);
 
-    U64 imageId = SID( imagePath.data());
-    Resource<ImageData> &image = mImageResources[ imageId];
-    image.resourcePath = imagePath;
-    image.resource.width = (U32)width;
-    image.resource.height = (U32)height;
-    image.resource.pixelData.Resize( imageSize);
-    memcpy( image.resource.pixelData.Data(), pixels, imageSize);
+    AddImage( imagePath, TakePixels( pixels, width, height));
 }
 
     
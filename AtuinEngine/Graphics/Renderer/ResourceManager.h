@@ -6,6 +6,7 @@
 #include "Material.h"
 #include "Core/Util/Types.h"
 #include "Core/DataStructures/Map.h"
+#include "Core/Jobs/Coroutine.h"
 
 #include <string>
 
@@ -35,6 +36,11 @@ public:
 
     MeshData* GetMesh( std::string_view meshPath);
     ImageData* GetImage( std::string_view imagePath);
+    bool HasImage( std::string_view imagePath);
+
+    // Reads the image on an I/O thread and decodes it on a job worker, the cache is left alone so that loads can run in parallel.
+    Coroutine<ImageData> LoadImageAsync( std::string imagePath);
+    ImageData* AddImage( std::string_view imagePath, ImageData &&imageData);
 
 private:
 
@@ -41,6 +41,8 @@ InputModule::~InputModule() {
 
 void InputModule::StartUp(GLFWwindow *window) {
 
+    MemoryTagScope tagScope( MemoryTag::INPUT);
+
     sWindow = window;
     
     glfwSetWindowUserPointer(sWindow, this);
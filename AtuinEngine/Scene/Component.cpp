@@ -7,6 +7,7 @@ namespace Atuin {
 
 MemoryManager* Component::sMemoryManager = nullptr;
 Map<U64, Component::PCreateFunc> Component::sConstructors;
+Map<U64, Component::ComponentLayout> Component::sComponentLayouts;
 Map<std::string, bool> Component::sComponentTypes;
 
 
@@ -55,6 +55,12 @@ class Component {
 
     using PCreateFunc = Component* (*)();
 
+    struct ComponentLayout {
+
+        Size size;
+        Size alignment;
+    };
+
 
     friend class Entity;
     friend class Scene;
@@ -83,6 +89,9 @@ public:
         // add component constructor
         sConstructors[ componentTypeIdx] = &CreateFunc<Derived>;
 
+        // MemoryManager creates one pool per registered layout
+        sComponentLayouts[ componentTypeIdx] = ComponentLayout{ sizeof(Derived), alignof(Derived)};
+
         // add to component type dict
         sComponentTypes[ Derived::Type()] = isUnique;
 
@@ -151,7 +160,13 @@ private:
         return sConstructors[ componentTypeIdx]();
     }
 
+    static void Destroy( Component *component) {
+
+        sMemoryManager->DeleteComponent( component);
+    }
+
     static Map<U64, PCreateFunc> sConstructors;
+    static Map<U64, ComponentLayout> sComponentLayouts;
     static Map<std::string, bool> sComponentTypes;
 };
 
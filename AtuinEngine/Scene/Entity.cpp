@@ -122,6 +122,7 @@ void Entity::OnDestroy() {
         for ( auto component : components)
         {
             component->OnDestroy();
+            Component::Destroy( component);
         }
     }
     // for ( auto component : mComponents)
@@ -11,6 +11,8 @@ namespace Atuin {
 
 void Scene::Load( const Json &sceneData) {
 
+    MemoryTagScope tagScope( MemoryTag::SCENE);
+
     pSceneRoot = new Entity( "Root");
     mEntities[ SID("Root")] = pSceneRoot;
    
@@ -0,0 +1,767 @@
+
+#include "Core/Memory/StackAllocator.h"
+#include "Core/Memory/FrameAllocator.h"
+#include "Core/Memory/PoolAllocator.h"
+#include "Core/Memory/LockFreePoolAllocator.h"
+#include "Core/Memory/FreeListAllocator.h"
+#include "Core/Memory/FreeTreeAllocator.h"
+#include "Core/Memory/SizeClassAllocator.h"
+#include "Core/Memory/TLSFAllocator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+using namespace Atuin;
+
+using Clock = std::chrono::steady_clock;
+
+
+namespace {
+
+
+constexpr Size ARENA_SIZE = 256 * MB;
+constexpr Size POOL_CHUNK_SIZE = 64;
+constexpr U8   ALIGNMENT = 16;
+
+
+/* @brief Baseline that forwards to the system allocator.
+ */
+class MallocAllocator : public IAllocator {
+
+public:
+
+    MallocAllocator() : IAllocator(ARENA_SIZE) {}
+
+    void* Allocate(Size size, U8 alignment) override { (void)alignment; return std::malloc(size); }
+    void  Free(void *ptr) override { std::free(ptr); }
+    void  Clear() override {}
+};
+
+
+/* @brief Allocator under test and the access patterns it supports.
+ */
+struct AllocatorSetup {
+
+    const char *name;
+    // false if allocations have to be freed in reverse order
+    bool arbitraryFree;
+    // only usable if memory is released with BeginFrame()
+    bool frameOnly;
+    Size maxSize;
+    std::function<std::unique_ptr<IAllocator>()> create;
+};
+
+
+struct Op {
+
+    enum Type : U8 { ALLOCATE, FREE, END_FRAME };
+
+    Type type;
+    U32  slot;
+    U32  size;
+};
+
+
+/* @brief Recorded sequence of allocations and frees, replayed against every compatible allocator.
+ *        Allocations still alive at the end are used to measure fragmentation before they are released.
+ */
+struct Trace {
+
+    const char *name;
+    bool lifo;
+    bool frames;
+    Size maxSize;
+    Size numSlots;
+    std::vector<Op> ops;
+};
+
+
+struct Result {
+
+    double opsPerSec;
+    double p50, p99, p999, max;
+    // allocator bytes / requested bytes of live allocations
+    double overhead;
+    // 1 - largest allocatable block / free memory
+    double fragmentation;
+    // reading every live allocation in random order
+    double scanNsPerAccess;
+    double scanTLBMisses;
+};
+
+
+/* @brief Counts data TLB load misses of the calling thread, reports NaN if perf events are not available.
+ */
+class TLBMissCounter {
+
+public:
+
+    TLBMissCounter() {
+
+#ifdef __linux__
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        mFd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~TLBMissCounter() {
+
+#ifdef __linux__
+        if (mFd >= 0)
+        {
+            close(mFd);
+        }
+#endif
+    }
+
+    void Start() {
+
+#ifdef __linux__
+        if (mFd >= 0)
+        {
+            ioctl(mFd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(mFd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    double Stop() {
+
+#ifdef __linux__
+        U64 count = 0;
+        if (mFd >= 0 && ioctl(mFd, PERF_EVENT_IOC_DISABLE, 0) == 0 && read(mFd, &count, sizeof(count)) == sizeof(count))
+        {
+            return (double)count;
+        }
+#endif
+        return std::nan("");
+    }
+
+
+private:
+
+    int mFd = -1;
+};
+
+
+bool Compatible(const AllocatorSetup &allocator, const Trace &trace) {
+
+    return (trace.lifo || allocator.arbitraryFree)
+        && (trace.frames || !allocator.frameOnly)
+        && trace.maxSize <= allocator.maxSize;
+}
+
+
+// backing only applies to the allocators that own their memory region
+std::vector<AllocatorSetup> CreateAllocators(const PageBacking &backing) {
+
+    constexpr Size NO_LIMIT = std::numeric_limits<Size>::max();
+    static constexpr Size NUM_POOL_CHUNKS = 64 * MB / POOL_CHUNK_SIZE;
+
+    return {
+        { "malloc",        true,  false, NO_LIMIT, []{ return std::make_unique<MallocAllocator>(); } },
+        { "Stack",         false, false, NO_LIMIT, [backing]{ return std::make_unique<StackAllocator>(ARENA_SIZE, nullptr, backing); } },
+        { "Frame",         true,  true,  NO_LIMIT, []{ return std::make_unique<FrameAllocator>(ARENA_SIZE / 2, 2); } },
+        { "Pool",          true,  false, POOL_CHUNK_SIZE, []{ return std::make_unique<PoolAllocator>(NUM_POOL_CHUNKS, POOL_CHUNK_SIZE); } },
+        { "LockFreePool",  true,  false, POOL_CHUNK_SIZE, []{ return std::make_unique<LockFreePoolAllocator>(NUM_POOL_CHUNKS, POOL_CHUNK_SIZE); } },
+        { "FreeList",      true,  false, NO_LIMIT, [backing]{ return std::make_unique<FreeListAllocator>(ARENA_SIZE, nullptr, backing); } },
+        { "FreeTree",      true,  false, NO_LIMIT, [backing]{ return std::make_unique<FreeTreeAllocator>(ARENA_SIZE, nullptr, backing); } },
+        { "TLSF",          true,  false, NO_LIMIT, [backing]{ return std::make_unique<TLSFAllocator>(ARENA_SIZE, nullptr, backing); } },
+        { "SizeClass",     true,  false, SizeClassAllocator::MAX_CHUNK_SIZE, []{ return std::make_unique<SizeClassAllocator>(ARENA_SIZE, nullptr, 32); } },
+    };
+}
+
+
+// log uniform sizes, small allocations dominate like in a real workload
+U32 RandomSize(std::mt19937 &rng, U32 minSize, U32 maxSize) {
+
+    std::uniform_real_distribution<double> dist( std::log((double)minSize), std::log((double)maxSize + 1) );
+
+    return std::min( (U32)std::exp(dist(rng)), maxSize );
+}
+
+
+/* @brief Allocations with random sizes and lifetimes, a live set of numSlots allocations is kept.
+ */
+Trace RandomTrace(const char *name, Size numOps, Size numSlots, U32 minSize, U32 maxSize, U32 seed) {
+
+    Trace trace{ name, false, false, maxSize, numSlots, {} };
+    trace.ops.reserve(numOps);
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<Size> slotDist(0, numSlots - 1);
+    std::vector<bool> used(numSlots, false);
+
+    for (Size i = 0; i < numOps; i++)
+    {
+        U32 slot = (U32)slotDist(rng);
+        if (used[slot])
+        {
+            trace.ops.push_back({ Op::FREE, slot, 0 });
+        }
+        else
+        {
+            trace.ops.push_back({ Op::ALLOCATE, slot, RandomSize(rng, minSize, maxSize) });
+        }
+        used[slot] = !used[slot];
+    }
+
+    return trace;
+}
+
+
+/* @brief Batches of allocations released either in reverse (LIFO) or in allocation order (FIFO).
+ */
+Trace BatchTrace(const char *name, bool lifo, Size numOps, Size batchSize, U32 minSize, U32 maxSize, U32 seed) {
+
+    Trace trace{ name, lifo, false, maxSize, batchSize, {} };
+    trace.ops.reserve(numOps);
+
+    std::mt19937 rng(seed);
+
+    while (trace.ops.size() + 2 * batchSize <= numOps)
+    {
+        for (Size i = 0; i < batchSize; i++)
+        {
+            trace.ops.push_back({ Op::ALLOCATE, (U32)i, RandomSize(rng, minSize, maxSize) });
+        }
+        for (Size i = 0; i < batchSize; i++)
+        {
+            trace.ops.push_back({ Op::FREE, (U32)(lifo ? batchSize - 1 - i : i), 0 });
+        }
+    }
+
+    return trace;
+}
+
+
+/* @brief Per frame transient allocations that are all released at the end of the frame.
+ */
+Trace FrameTrace(const char *name, Size numOps, Size allocationsPerFrame, U32 minSize, U32 maxSize, U32 seed) {
+
+    Trace trace{ name, true, true, maxSize, allocationsPerFrame, {} };
+    trace.ops.reserve(numOps);
+
+    std::mt19937 rng(seed);
+
+    while (trace.ops.size() + 2 * allocationsPerFrame + 1 <= numOps)
+    {
+        for (Size i = 0; i < allocationsPerFrame; i++)
+        {
+            trace.ops.push_back({ Op::ALLOCATE, (U32)i, RandomSize(rng, minSize, maxSize) });
+        }
+        for (Size i = allocationsPerFrame; i > 0; i--)
+        {
+            trace.ops.push_back({ Op::FREE, (U32)(i - 1), 0 });
+        }
+        trace.ops.push_back({ Op::END_FRAME, 0, 0 });
+    }
+
+    return trace;
+}
+
+
+// Runs a single op, returns false if the allocator ran out of memory.
+inline bool Execute(IAllocator &allocator, const Op &op, std::vector<void*> &slots) {
+
+    switch (op.type)
+    {
+    case Op::ALLOCATE:
+        try
+        {
+            slots[op.slot] = allocator.Allocate(op.size, ALIGNMENT);
+        }
+        catch (const std::overflow_error&)
+        {
+            return false;
+        }
+        break;
+
+    case Op::FREE:
+        allocator.Free(slots[op.slot]);
+        slots[op.slot] = nullptr;
+        break;
+
+    case Op::END_FRAME:
+        if (FrameAllocator *frameAllocator = dynamic_cast<FrameAllocator*>(&allocator))
+        {
+            frameAllocator->BeginFrame();
+        }
+        break;
+    }
+
+    return true;
+}
+
+
+void ReleaseSlots(IAllocator &allocator, std::vector<void*> &slots) {
+
+    for (void *&ptr : slots)
+    {
+        if (ptr != nullptr)
+        {
+            allocator.Free(ptr);
+            ptr = nullptr;
+        }
+    }
+}
+
+
+// Largest block that can still be allocated, found with a binary search over the free memory.
+Size LargestAllocatable(IAllocator &allocator) {
+
+    Size low = 0;
+    Size high = allocator.TotalMemory() - allocator.UsedMemory();
+    while (low < high)
+    {
+        Size size = low + (high - low + 1) / 2;
+        try
+        {
+            allocator.Free( allocator.Allocate(size, ALIGNMENT) );
+            low = size;
+        }
+        catch (const std::overflow_error&)
+        {
+            high = size - 1;
+        }
+    }
+
+    return low;
+}
+
+
+void MeasureFragmentation(const AllocatorSetup &setup, IAllocator &allocator, const Trace &trace, const std::vector<void*> &slots, Result &result) {
+
+    result.overhead = std::nan("");
+    result.fragmentation = std::nan("");
+
+    // allocators that do not account for memory or can not free single allocations have nothing to measure
+    if (!setup.arbitraryFree || setup.frameOnly || allocator.UsedMemory() == 0)
+    {
+        return;
+    }
+
+    // sizes of the live allocations come from the last allocation into each slot
+    std::vector<U32> sizes(slots.size(), 0);
+    for (const Op &op : trace.ops)
+    {
+        if (op.type == Op::ALLOCATE)
+        {
+            sizes[op.slot] = op.size;
+        }
+    }
+
+    Size requested = 0;
+    for (Size i = 0; i < slots.size(); i++)
+    {
+        requested += slots[i] != nullptr ? sizes[i] : 0;
+    }
+
+    if (requested > 0)
+    {
+        result.overhead = (double)allocator.UsedMemory() / (double)requested;
+    }
+
+    // fixed size allocators can not fragment externally
+    if (setup.maxSize == std::numeric_limits<Size>::max())
+    {
+        Size freeMemory = allocator.TotalMemory() - allocator.UsedMemory();
+        result.fragmentation = 1.0 - (double)LargestAllocatable(allocator) / (double)freeMemory;
+    }
+}
+
+
+// Reads every live allocation in random order, this is dominated by cache and TLB misses if they are spread over many pages.
+void MeasureScan(const std::vector<void*> &slots, Result &result) {
+
+    result.scanNsPerAccess = std::nan("");
+    result.scanTLBMisses = std::nan("");
+
+    std::vector<const volatile Byte*> live;
+    for (void *ptr : slots)
+    {
+        if (ptr != nullptr)
+        {
+            live.push_back( static_cast<const volatile Byte*>(ptr) );
+        }
+    }
+    if (live.empty())
+    {
+        return;
+    }
+
+    std::mt19937 rng(42);
+    std::shuffle(live.begin(), live.end(), rng);
+
+    constexpr Size NUM_PASSES = 16;
+    TLBMissCounter counter;
+
+    counter.Start();
+    auto start = Clock::now();
+    for (Size pass = 0; pass < NUM_PASSES; pass++)
+    {
+        for (const volatile Byte *ptr : live)
+        {
+            (void)*ptr;
+        }
+    }
+    double nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    result.scanTLBMisses = counter.Stop();
+
+    result.scanNsPerAccess = nanoseconds / (double)(NUM_PASSES * live.size());
+}
+
+
+void ComputePercentiles(std::vector<U32> &latencies, Result &result) {
+
+    if (latencies.empty())
+    {
+        return;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    auto percentile = [&latencies](double p) {
+        return (double)latencies[ std::min( (Size)(p * (double)latencies.size()), latencies.size() - 1 ) ];
+    };
+
+    result.p50 = percentile(0.5);
+    result.p99 = percentile(0.99);
+    result.p999 = percentile(0.999);
+    result.max = (double)latencies.back();
+}
+
+
+/* @brief Replays the trace twice on fresh allocators:
+ *        once untimed per op for throughput and once with every op timed for the latency distribution.
+ */
+bool RunTrace(const AllocatorSetup &setup, const Trace &trace, Result &result) {
+
+    std::vector<void*> slots(trace.numSlots, nullptr);
+
+    {
+        std::unique_ptr<IAllocator> allocator = setup.create();
+
+        auto start = Clock::now();
+        for (const Op &op : trace.ops)
+        {
+            if (!Execute(*allocator, op, slots))
+            {
+                ReleaseSlots(*allocator, slots);
+                return false;
+            }
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.opsPerSec = (double)trace.ops.size() / seconds;
+
+        MeasureFragmentation(setup, *allocator, trace, slots, result);
+        MeasureScan(slots, result);
+        ReleaseSlots(*allocator, slots);
+    }
+
+    std::vector<U32> latencies;
+    latencies.reserve(trace.ops.size());
+    {
+        std::unique_ptr<IAllocator> allocator = setup.create();
+
+        for (const Op &op : trace.ops)
+        {
+            auto start = Clock::now();
+            Execute(*allocator, op, slots);
+            auto end = Clock::now();
+
+            if (op.type != Op::END_FRAME)
+            {
+                latencies.push_back( (U32)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() );
+            }
+        }
+
+        ReleaseSlots(*allocator, slots);
+    }
+
+    ComputePercentiles(latencies, result);
+
+    return true;
+}
+
+
+/* @brief Every thread replays its own random trace against one shared allocator.
+ */
+bool RunContention(const AllocatorSetup &setup, const std::vector<Trace> &traces, Result &result) {
+
+    Size numThreads = traces.size();
+    std::vector<std::vector<U32>> latencies(numThreads);
+    std::vector<char> failed(numThreads, 0);
+
+    for (int timed = 0; timed < 2; timed++)
+    {
+        std::unique_ptr<IAllocator> allocator = setup.create();
+        std::vector<std::thread> threads;
+
+        auto start = Clock::now();
+        for (Size t = 0; t < numThreads; t++)
+        {
+            threads.emplace_back([&, t, timed]() {
+
+                const Trace &trace = traces[t];
+                std::vector<void*> slots(trace.numSlots, nullptr);
+
+                if (timed)
+                {
+                    latencies[t].reserve(trace.ops.size());
+                }
+
+                for (const Op &op : trace.ops)
+                {
+                    auto opStart = timed ? Clock::now() : Clock::time_point{};
+                    if (!Execute(*allocator, op, slots))
+                    {
+                        failed[t] = 1;
+                        break;
+                    }
+                    if (timed)
+                    {
+                        latencies[t].push_back( (U32)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - opStart).count() );
+                    }
+                }
+
+                ReleaseSlots(*allocator, slots);
+            });
+        }
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (std::find(failed.begin(), failed.end(), 1) != failed.end())
+        {
+            return false;
+        }
+
+        if (!timed)
+        {
+            Size numOps = 0;
+            for (const Trace &trace : traces)
+            {
+                numOps += trace.ops.size();
+            }
+            result.opsPerSec = (double)numOps / seconds;
+        }
+    }
+
+    std::vector<U32> allLatencies;
+    for (const std::vector<U32> &threadLatencies : latencies)
+    {
+        allLatencies.insert(allLatencies.end(), threadLatencies.begin(), threadLatencies.end());
+    }
+    ComputePercentiles(allLatencies, result);
+
+    result.overhead = std::nan("");
+    result.fragmentation = std::nan("");
+    result.scanNsPerAccess = std::nan("");
+    result.scanTLBMisses = std::nan("");
+
+    return true;
+}
+
+
+void PrintHeader(bool csv) {
+
+    if (csv)
+    {
+        std::printf("trace,allocator,ops_per_sec,p50_ns,p99_ns,p999_ns,max_ns,overhead,fragmentation,scan_ns,scan_dtlb_misses\n");
+    }
+    else
+    {
+        std::printf("%-24s %-14s %14s %8s %8s %8s %10s %9s %9s %8s %12s\n",
+                    "trace", "allocator", "ops/s", "p50 ns", "p99 ns", "p99.9 ns", "max ns", "overhead", "ext.frag", "scan ns", "scan dTLB");
+    }
+}
+
+
+void PrintResult(bool csv, const char *trace, const char *allocator, const Result &result) {
+
+    if (csv)
+    {
+        std::printf("%s,%s,%.0f,%.0f,%.0f,%.0f,%.0f,%.4f,%.4f,%.2f,%.0f\n",
+                    trace, allocator, result.opsPerSec, result.p50, result.p99, result.p999, result.max, result.overhead, result.fragmentation,
+                    result.scanNsPerAccess, result.scanTLBMisses);
+        return;
+    }
+
+    char overhead[16] = "-";
+    char fragmentation[16] = "-";
+    char scanNs[16] = "-";
+    char scanTLBMisses[24] = "-";
+    if (!std::isnan(result.overhead))
+    {
+        std::snprintf(overhead, sizeof(overhead), "%.3f", result.overhead);
+    }
+    if (!std::isnan(result.fragmentation))
+    {
+        std::snprintf(fragmentation, sizeof(fragmentation), "%.1f%%", result.fragmentation * 100.0);
+    }
+    if (!std::isnan(result.scanNsPerAccess))
+    {
+        std::snprintf(scanNs, sizeof(scanNs), "%.2f", result.scanNsPerAccess);
+    }
+    if (!std::isnan(result.scanTLBMisses))
+    {
+        std::snprintf(scanTLBMisses, sizeof(scanTLBMisses), "%.0f", result.scanTLBMisses);
+    }
+
+    std::printf("%-24s %-14s %14.0f %8.0f %8.0f %8.0f %10.0f %9s %9s %8s %12s\n",
+                trace, allocator, result.opsPerSec, result.p50, result.p99, result.p999, result.max, overhead, fragmentation, scanNs, scanTLBMisses);
+}
+
+
+void PrintFailure(bool csv, const char *trace, const char *allocator) {
+
+    if (csv)
+    {
+        std::printf("%s,%s,out_of_memory,,,,,,\n", trace, allocator);
+    }
+    else
+    {
+        std::printf("%-24s %-14s %14s\n", trace, allocator, "out of memory");
+    }
+}
+
+
+} // anonymous
+
+
+/* @brief Compares all IAllocator implementations against malloc.
+ *        Usage: AllocatorBenchmark [--csv] [--ops <num ops per trace>] [--threads <num threads>] [--pages <page type>] [--prefault]
+ *        --pages and --prefault select the PageBacking of Stack, FreeList, FreeTree and TLSF, to compare e.g. MALLOC against TRANSPARENT_HUGE_PAGES.
+ */
+int main(int argc, char **argv) {
+
+    bool csv = false;
+    Size numOps = 200000;
+    Size numThreads = std::clamp<Size>(std::thread::hardware_concurrency(), 2, 8);
+    PageBacking backing;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--csv") == 0)
+        {
+            csv = true;
+        }
+        else if (std::strcmp(argv[i], "--ops") == 0 && i + 1 < argc)
+        {
+            numOps = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            numThreads = std::max<Size>(std::strtoull(argv[++i], nullptr, 10), 1);
+        }
+        else if (std::strcmp(argv[i], "--pages") == 0 && i + 1 < argc)
+        {
+            backing.type = PageMemory::ToPageType(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--prefault") == 0)
+        {
+            backing.prefault = true;
+        }
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--csv] [--ops <num ops per trace>] [--threads <num threads>] [--pages <page type>] [--prefault]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<AllocatorSetup> allocators = CreateAllocators(backing);
+    if (!csv)
+    {
+        std::printf("page backing %s%s\n\n", PageMemory::ToString(backing.type).c_str(), backing.prefault ? ", prefaulted" : "");
+    }
+
+    std::vector<Trace> traces;
+    traces.push_back( RandomTrace("random 16B-4KB", numOps, 4096, 16, 4096, 1) );
+    traces.push_back( RandomTrace("random 16B-1KB", numOps, 4096, 16, 1024, 2) );
+    traces.push_back( RandomTrace("random fixed 64B", numOps, 4096, 64, 64, 3) );
+    traces.push_back( BatchTrace("LIFO 16B-4KB", true, numOps, 1000, 16, 4096, 4) );
+    traces.push_back( BatchTrace("FIFO 16B-4KB", false, numOps, 1000, 16, 4096, 5) );
+    traces.push_back( FrameTrace("game frame 16B-1KB", numOps, 2000, 16, 1024, 6) );
+
+    PrintHeader(csv);
+
+    for (const Trace &trace : traces)
+    {
+        for (const AllocatorSetup &allocator : allocators)
+        {
+            if (!Compatible(allocator, trace))
+            {
+                continue;
+            }
+
+            Result result{};
+            if (RunTrace(allocator, trace, result))
+            {
+                PrintResult(csv, trace.name, allocator.name, result);
+            }
+            else
+            {
+                PrintFailure(csv, trace.name, allocator.name);
+            }
+        }
+    }
+
+    // multi threaded contention on a single shared allocator
+    std::vector<Trace> threadTraces;
+    for (Size t = 0; t < numThreads; t++)
+    {
+        threadTraces.push_back( RandomTrace("", numOps / numThreads, 256, 16, 64, (U32)(100 + t)) );
+    }
+
+    char contentionName[32];
+    std::snprintf(contentionName, sizeof(contentionName), "contention 16B-64B x%zu", numThreads);
+
+    for (const AllocatorSetup &allocator : allocators)
+    {
+        if (!Compatible(allocator, threadTraces.front()))
+        {
+            continue;
+        }
+
+        Result result{};
+        if (RunContention(allocator, threadTraces, result))
+        {
+            PrintResult(csv, contentionName, allocator.name, result);
+        }
+        else
+        {
+            PrintFailure(csv, contentionName, allocator.name);
+        }
+    }
+
+    return 0;
+}
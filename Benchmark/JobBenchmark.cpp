@@ -0,0 +1,479 @@
+#include "Core/Jobs/JobManager.h"
+#include "Core/Config/ConfigManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+
+using namespace Atuin;
+
+using Clock = std::chrono::steady_clock;
+
+
+namespace {
+
+
+constexpr Size BATCH_SIZE = 1024;
+constexpr Size TREE_FANOUT = 4;
+constexpr Size TREE_DEPTH = 3;
+// events per thread while steals are counted, large enough for one traced repetition of every benchmark
+constexpr const char *TRACE_EVENTS = "262144";
+
+
+struct Result {
+
+    Size   ops;
+    double opsPerSec;
+    double nsPerOp;
+    // latency of one repetition in microseconds, NaN if not measured
+    double p50;
+    double p99;
+    double max;
+    double stealsPerJob;
+    double speedup;
+};
+
+
+struct Mat4 { float m[16]; };
+struct Vec4 { float v[4]; };
+
+
+// same layout and copy pattern as Renderer::UpdateObjectBuffer()
+struct ObjectData {
+
+    Mat4 transform;
+    Vec4 sphereBounds;
+};
+
+
+struct RenderObject {
+
+    const Mat4 *transform;
+    const Vec4 *sphereBounds;
+    bool updated;
+};
+
+
+struct Scene {
+
+    Scene(Size numObjects);
+
+    std::vector<Mat4> transforms;
+    std::vector<Vec4> bounds;
+    std::vector<RenderObject> objects;
+    std::vector<Size> dirtyIndices;
+    std::vector<ObjectData> objectBuffer;
+};
+
+
+Scene::Scene(Size numObjects) :
+    transforms(numObjects),
+    bounds(numObjects),
+    objects(numObjects),
+    dirtyIndices(numObjects),
+    objectBuffer(numObjects)
+{
+    for (Size i = 0; i < numObjects; i++)
+    {
+        for (Size j = 0; j < 16; j++)
+        {
+            transforms[i].m[j] = (float)(i + j);
+        }
+        bounds[i] = Vec4{ { (float)i, 0.f, 0.f, 1.f } };
+        objects[i] = RenderObject{ &transforms[i], &bounds[i], true };
+        dirtyIndices[i] = i;
+    }
+}
+
+
+void CopyObject(Scene &scene, Size j) {
+
+    RenderObject &object = scene.objects[ scene.dirtyIndices[j]];
+    scene.objectBuffer[j].transform = *object.transform;
+    scene.objectBuffer[j].sphereBounds = *object.sphereBounds;
+    object.updated = false;
+}
+
+
+double Seconds(Clock::time_point start) {
+
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+
+void ComputePercentiles(std::vector<double> &latencies, Result &result) {
+
+    if (latencies.empty())
+    {
+        result.p50 = result.p99 = result.max = std::nan("");
+        return;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+
+        Size index = std::min( (Size)(p * (double)latencies.size()), latencies.size() - 1 );
+        return latencies[index];
+    };
+    result.p50 = percentile(0.5);
+    result.p99 = percentile(0.99);
+    result.max = latencies.back();
+}
+
+
+/* @brief Runs the workload once more with the tracer enabled and returns the number of steals per executed job.
+ *        Not part of the timed repetitions, tracing adds a few ns to every job.
+ */
+template<typename F>
+double MeasureSteals(JobManager &jobManager, F &&workload) {
+
+    jobManager.StartTrace();
+    workload();
+    jobManager.StopTrace();
+
+    const JobTracer &tracer = jobManager.Tracer();
+    Size numSteals = 0;
+    Size numJobs = 0;
+    for (Size thread = 0; thread < jobManager.NumThreads(); thread++)
+    {
+        numSteals += tracer.NumEvents(thread, TraceEventType::STEAL);
+        numJobs += tracer.NumEvents(thread, TraceEventType::JOB);
+    }
+
+    return numJobs > 0 ? (double)numSteals / (double)numJobs : std::nan("");
+}
+
+
+Result EmptyResult() {
+
+    Result result{};
+    result.p50 = result.p99 = result.max = std::nan("");
+    result.stealsPerJob = std::nan("");
+    result.speedup = std::nan("");
+
+    return result;
+}
+
+
+// Cost of CreateJob() alone, the jobs are run outside of the timed section in batches to release their slots.
+Result BenchmarkCreate(JobManager &jobManager, Size numJobs) {
+
+    Result result = EmptyResult();
+
+    std::vector<JobID> batch(BATCH_SIZE);
+    double seconds = 0.0;
+    for (Size created = 0; created < numJobs; created += BATCH_SIZE)
+    {
+        JobID parent = jobManager.CreateJob( [](void*){}, nullptr);
+
+        auto start = Clock::now();
+        for (Size i = 0; i < BATCH_SIZE; i++)
+        {
+            batch[i] = jobManager.CreateJob( [](void*){}, nullptr, parent);
+        }
+        seconds += Seconds(start);
+
+        for (JobID id : batch)
+        {
+            jobManager.Run(id);
+        }
+        jobManager.Run(parent);
+        jobManager.Wait(parent);
+    }
+
+    result.ops = (numJobs + BATCH_SIZE - 1) / BATCH_SIZE * BATCH_SIZE;
+    result.opsPerSec = (double)result.ops / seconds;
+    result.nsPerOp = seconds * 1e9 / (double)result.ops;
+
+    return result;
+}
+
+
+void RunEmptyBatch(JobManager &jobManager) {
+
+    JobID parent = jobManager.CreateJob( [](void*){}, nullptr);
+    for (Size i = 0; i < BATCH_SIZE; i++)
+    {
+        jobManager.Run( jobManager.CreateJob( [](void*){}, nullptr, parent) );
+    }
+    jobManager.Run(parent);
+    jobManager.Wait(parent);
+}
+
+
+// Jobs created, run and waited on per second, in batches of children of one parent.
+Result BenchmarkEmptyJobs(JobManager &jobManager, Size numJobs) {
+
+    Result result = EmptyResult();
+
+    Size numBatches = std::max(numJobs / BATCH_SIZE, (Size)1);
+    std::vector<double> latencies;
+    latencies.reserve(numBatches);
+
+    auto start = Clock::now();
+    for (Size i = 0; i < numBatches; i++)
+    {
+        auto batchStart = Clock::now();
+        RunEmptyBatch(jobManager);
+        latencies.push_back( Seconds(batchStart) * 1e6 );
+    }
+    double seconds = Seconds(start);
+
+    result.ops = numBatches * BATCH_SIZE;
+    result.opsPerSec = (double)result.ops / seconds;
+    result.nsPerOp = seconds * 1e9 / (double)result.ops;
+    ComputePercentiles(latencies, result);
+    result.stealsPerJob = MeasureSteals(jobManager, [&jobManager](){ RunEmptyBatch(jobManager); });
+
+    return result;
+}
+
+
+// Every inner node runs TREE_FANOUT children and waits on each of them, so its fiber is suspended until they are done.
+void ForkJoinNode(JobManager &jobManager, Size depth) {
+
+    if (depth == 0)
+    {
+        return;
+    }
+
+    JobID children[TREE_FANOUT];
+    for (Size i = 0; i < TREE_FANOUT; i++)
+    {
+        children[i] = jobManager.CreateJob( [&jobManager, depth](void*){ ForkJoinNode(jobManager, depth - 1); }, nullptr);
+        jobManager.Run(children[i]);
+    }
+    for (Size i = 0; i < TREE_FANOUT; i++)
+    {
+        jobManager.Wait(children[i]);
+    }
+}
+
+
+void RunForkJoinTree(JobManager &jobManager) {
+
+    JobID root = jobManager.CreateJob( [&jobManager](void*){ ForkJoinNode(jobManager, TREE_DEPTH); }, nullptr);
+    jobManager.Run(root);
+    jobManager.Wait(root);
+}
+
+
+// Jobs per second in CreateJob + Run + Wait trees, latencies from creating the root until the whole tree has finished.
+Result BenchmarkForkJoin(JobManager &jobManager, Size numJobs) {
+
+    Result result = EmptyResult();
+
+    Size treeSize = 1;
+    for (Size level = 1, width = 1; level <= TREE_DEPTH; level++)
+    {
+        width *= TREE_FANOUT;
+        treeSize += width;
+    }
+
+    Size numTrees = std::max(numJobs / treeSize, (Size)1);
+    std::vector<double> latencies;
+    latencies.reserve(numTrees);
+
+    auto start = Clock::now();
+    for (Size i = 0; i < numTrees; i++)
+    {
+        auto treeStart = Clock::now();
+        RunForkJoinTree(jobManager);
+        latencies.push_back( Seconds(treeStart) * 1e6 );
+    }
+    double seconds = Seconds(start);
+
+    result.ops = numTrees * treeSize;
+    result.opsPerSec = (double)result.ops / seconds;
+    result.nsPerOp = seconds * 1e9 / (double)result.ops;
+    ComputePercentiles(latencies, result);
+    result.stealsPerJob = MeasureSteals(jobManager, [&jobManager](){ RunForkJoinTree(jobManager); });
+
+    return result;
+}
+
+
+// UpdateObjectBuffer() over every object of the scene once per frame, jobManager nullptr copies on the calling thread only.
+Result BenchmarkObjectUpdate(JobManager *jobManager, Scene &scene, Size numFrames) {
+
+    Result result = EmptyResult();
+
+    Size numObjects = scene.objects.size();
+    auto update = [jobManager, &scene, numObjects]() {
+
+        if (jobManager == nullptr)
+        {
+            for (Size j = 0; j < numObjects; j++)
+            {
+                CopyObject(scene, j);
+            }
+        }
+        else
+        {
+            jobManager->ParallelFor(0, numObjects, [&scene](Size j){ CopyObject(scene, j); });
+        }
+    };
+
+    // first touch of the object buffer is not part of the measurement
+    update();
+
+    std::vector<double> latencies;
+    latencies.reserve(numFrames);
+
+    auto start = Clock::now();
+    for (Size i = 0; i < numFrames; i++)
+    {
+        auto frameStart = Clock::now();
+        update();
+        latencies.push_back( Seconds(frameStart) * 1e6 );
+    }
+    double seconds = Seconds(start);
+
+    result.ops = numObjects * numFrames;
+    result.opsPerSec = (double)result.ops / seconds;
+    result.nsPerOp = seconds * 1e9 / (double)result.ops;
+    ComputePercentiles(latencies, result);
+    if (jobManager != nullptr)
+    {
+        result.stealsPerJob = MeasureSteals(*jobManager, update);
+    }
+
+    return result;
+}
+
+
+void PrintHeader(bool csv) {
+
+    if (csv)
+    {
+        std::printf("benchmark,threads,ops,ops_per_sec,ns_per_op,p50_us,p99_us,max_us,steals_per_job,speedup\n");
+    }
+    else
+    {
+        std::printf("%-18s %7s %10s %14s %10s %10s %10s %10s %11s %8s\n",
+                    "benchmark", "threads", "ops", "ops/s", "ns/op", "p50 us", "p99 us", "max us", "steals/job", "speedup");
+    }
+}
+
+
+void PrintResult(bool csv, const char *benchmark, Size numThreads, const Result &result) {
+
+    if (csv)
+    {
+        std::printf("%s,%zu,%zu,%.0f,%.2f,%.2f,%.2f,%.2f,%.4f,%.3f\n",
+                    benchmark, numThreads, result.ops, result.opsPerSec, result.nsPerOp, result.p50, result.p99, result.max,
+                    result.stealsPerJob, result.speedup);
+        return;
+    }
+
+    auto format = [](char *buffer, Size size, const char *fmt, double value) {
+
+        if (std::isnan(value))
+        {
+            std::snprintf(buffer, size, "-");
+        }
+        else
+        {
+            std::snprintf(buffer, size, fmt, value);
+        }
+    };
+
+    char p50[16], p99[16], max[16], steals[16], speedup[16];
+    format(p50, sizeof(p50), "%.1f", result.p50);
+    format(p99, sizeof(p99), "%.1f", result.p99);
+    format(max, sizeof(max), "%.1f", result.max);
+    format(steals, sizeof(steals), "%.4f", result.stealsPerJob);
+    format(speedup, sizeof(speedup), "%.2fx", result.speedup);
+
+    std::printf("%-18s %7zu %10zu %14.0f %10.2f %10s %10s %10s %11s %8s\n",
+                benchmark, numThreads, result.ops, result.opsPerSec, result.nsPerOp, p50, p99, max, steals, speedup);
+}
+
+
+} // anonymous
+
+
+/* @brief Measures the JobManager from single job overheads up to a frame sized workload, for every thread count from 1 to --threads.
+ *        Usage: JobBenchmark [--csv] [--threads <max threads>] [--jobs <num jobs>] [--objects <num objects>] [--frames <num frames>] [--pin]
+ *        Threads include the main thread. JobManager always has at least one worker, so 1 thread only runs the serial object update
+ *        that the speedup of the other thread counts is relative to. Steals per job come from an extra, traced repetition.
+ */
+int main(int argc, char **argv) {
+
+    bool csv = false;
+    bool pin = false;
+    Size maxThreads = std::max<Size>(std::thread::hardware_concurrency(), 2);
+    Size numJobs = 200000;
+    Size numObjects = 1000000;
+    Size numFrames = 20;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--csv") == 0)
+        {
+            csv = true;
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            maxThreads = std::max<Size>(std::strtoull(argv[++i], nullptr, 10), 1);
+        }
+        else if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+        {
+            numJobs = std::max<Size>(std::strtoull(argv[++i], nullptr, 10), 1);
+        }
+        else if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+        {
+            numObjects = std::max<Size>(std::strtoull(argv[++i], nullptr, 10), 1);
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            numFrames = std::max<Size>(std::strtoull(argv[++i], nullptr, 10), 1);
+        }
+        else if (std::strcmp(argv[i], "--pin") == 0)
+        {
+            pin = true;
+        }
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--csv] [--threads <max threads>] [--jobs <num jobs>] [--objects <num objects>] [--frames <num frames>] [--pin]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    ConfigManager config;
+    config.SetCVar("Multithreading", "JOB_TRACE_EVENTS", TRACE_EVENTS);
+    config.SetCVar("Multithreading", "PIN_THREADS", pin ? "1" : "0");
+
+    Scene scene(numObjects);
+
+    PrintHeader(csv);
+
+    Result serial = BenchmarkObjectUpdate(nullptr, scene, numFrames);
+    serial.speedup = 1.0;
+    PrintResult(csv, "object update", 1, serial);
+
+    for (Size numThreads = 2; numThreads <= maxThreads; numThreads++)
+    {
+        JobManager jobManager(numThreads - 1);
+        jobManager.StartUp();
+
+        PrintResult(csv, "create", numThreads, BenchmarkCreate(jobManager, numJobs));
+        PrintResult(csv, "empty jobs", numThreads, BenchmarkEmptyJobs(jobManager, numJobs));
+        PrintResult(csv, "fork/join 4^3", numThreads, BenchmarkForkJoin(jobManager, numJobs));
+
+        Result update = BenchmarkObjectUpdate(&jobManager, scene, numFrames);
+        update.speedup = serial.p50 / update.p50;
+        PrintResult(csv, "object update", numThreads, update);
+
+        jobManager.ShutDown();
+        std::fflush(stdout);
+    }
+
+    return 0;
+}
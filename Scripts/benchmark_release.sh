@@ -0,0 +1,3 @@
+#! /bin/sh
+
+cd ../Build/Release; ./Benchmark/AllocatorBenchmark "$@"
\ No newline at end of file
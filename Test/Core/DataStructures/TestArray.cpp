@@ -2,6 +2,7 @@
 #include <catch2/catch.hpp>
 
 #include "Core/DataStructures/Array.h"
+#include "Core/Memory/FreeListAllocator.h"
 
 
 using namespace Atuin;
@@ -242,4 +243,25 @@ TEST_CASE("erase an element", "[array]") {
         REQUIRE(arr.GetSize() == 3);
         REQUIRE(arr == Array<int>{1,2,3}); 
     }
+}
+
+
+TEST_CASE("array with custom allocator", "[array]") {
+
+    FreeListAllocator allocator(1_MB);
+    {
+        Array<int> arr(&allocator);
+        REQUIRE(arr.GetAllocator() == &allocator);
+
+        for (int i = 0; i < 100; i++)
+        {
+            arr.PushBack(i);
+        }
+        REQUIRE(allocator.UsedMemory() >= 100 * sizeof(int));
+
+        Array<int> arr2(std::move(arr));
+        REQUIRE(arr2.GetAllocator() == &allocator);
+        REQUIRE(arr2[99] == 99);
+    }
+    REQUIRE(allocator.UsedMemory() == 0);
 }
\ No newline at end of file
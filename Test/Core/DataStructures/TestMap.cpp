@@ -2,6 +2,7 @@
 #include <catch2/catch.hpp>
 
 #include "Core/DataStructures/Map.h"
+#include "Core/Memory/FreeListAllocator.h"
 
 #include <iostream>
 
@@ -125,4 +126,32 @@ TEST_CASE("find map element", "[map]") {
     REQUIRE(mp.Find(1.2) == mp.Begin());
     REQUIRE(mp.Find(2.3)->second == 23);
     REQUIRE(mp.Find(3.4) == mp.End());
+}
+
+
+TEST_CASE("map with custom allocator", "[map]") {
+
+    FreeListAllocator allocator(1_MB);
+    {
+        Map<int, int> mp(4, 1.0f, &allocator);
+        REQUIRE(mp.GetAllocator() == &allocator);
+
+        // nodes and rehashed buckets come from the allocator
+        for (int i = 0; i < 100; i++)
+        {
+            mp.Insert(i, 2 * i);
+        }
+        REQUIRE(mp.GetNumBuckets() > 4);
+        REQUIRE(allocator.UsedMemory() >= 100 * sizeof(std::pair<int, int>));
+
+        for (int i = 0; i < 50; i++)
+        {
+            mp.Erase(i);
+        }
+        REQUIRE(mp.GetSize() == 50);
+
+        Map<int, int> mp2(std::move(mp));
+        REQUIRE(mp2.GetAllocator() == &allocator);
+    }
+    REQUIRE(allocator.UsedMemory() == 0);
 }
\ No newline at end of file
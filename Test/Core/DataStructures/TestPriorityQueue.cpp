@@ -2,6 +2,7 @@
 #include <catch2/catch.hpp>
 
 #include "Core/DataStructures/PriorityQueue.h"
+#include "Core/Memory/FreeListAllocator.h"
 
 
 using namespace Atuin;
@@ -141,4 +142,22 @@ TEST_CASE("use custom comparator", "[priority queue]") {
         
         REQUIRE(pq2.Top() == 9.3f);
     }
+}
+
+
+TEST_CASE("priority queue with custom allocator", "[priority queue]") {
+
+    FreeListAllocator allocator(1_MB);
+    {
+        PriorityQueue<int> pq(&allocator);
+        REQUIRE(pq.GetAllocator() == &allocator);
+
+        for (int i = 100; i > 0; i--)
+        {
+            pq.Push(i);
+        }
+        REQUIRE(allocator.UsedMemory() >= 100 * sizeof(int));
+        REQUIRE(pq.Top() == 1);
+    }
+    REQUIRE(allocator.UsedMemory() == 0);
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <catch2/catch.hpp>
 
 #include "Core/DataStructures/Queue.h"
+#include "Core/Memory/FreeListAllocator.h"
 
 
 using namespace Atuin;
@@ -128,4 +129,24 @@ TEST_CASE("access queue elements", "[queue]") {
         REQUIRE_THROWS(q.Front());
         REQUIRE_THROWS(q.Back());
     }
+}
+
+
+TEST_CASE("queue with custom allocator", "[queue]") {
+
+    FreeListAllocator allocator(1_MB);
+    {
+        Queue<int> q(&allocator);
+        REQUIRE(q.GetAllocator() == &allocator);
+
+        for (int i = 0; i < 100; i++)
+        {
+            q.Push(i);
+        }
+        REQUIRE(q.GetAllocator() == &allocator);
+        REQUIRE(allocator.UsedMemory() >= 100 * sizeof(int));
+        REQUIRE(q.Front() == 0);
+        REQUIRE(q.Back() == 99);
+    }
+    REQUIRE(allocator.UsedMemory() == 0);
 }
\ No newline at end of file
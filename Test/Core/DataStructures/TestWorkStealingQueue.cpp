@@ -0,0 +1,160 @@
+#include <catch2/catch.hpp>
+
+#include "Core/DataStructures/WorkStealingQueue.h"
+#include "Core/DataStructures/Array.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+using namespace Atuin;
+
+
+TEST_CASE("work stealing queue order", "[workstealingqueue]") {
+
+    WorkStealingQueue<int> queue(4);
+    REQUIRE( queue.IsEmpty() );
+    REQUIRE( queue.GetCapacity() == 4 );
+
+    for (int i = 0; i < 4; i++)
+    {
+        REQUIRE( queue.Push(i) );
+    }
+    REQUIRE( queue.GetSize() == 4 );
+
+    // owner pops the newest element, thieves take the oldest
+    int value = -1;
+    REQUIRE( queue.Pop(value) );
+    REQUIRE( value == 3 );
+    REQUIRE( queue.Steal(value) );
+    REQUIRE( value == 0 );
+    REQUIRE( queue.Pop(value) );
+    REQUIRE( value == 2 );
+    REQUIRE( queue.Pop(value) );
+    REQUIRE( value == 1 );
+
+    REQUIRE( !queue.Pop(value) );
+    REQUIRE( !queue.Steal(value) );
+    REQUIRE( queue.IsEmpty() );
+}
+
+
+TEST_CASE("work stealing queue grows when full", "[workstealingqueue]") {
+
+    WorkStealingQueue<int> queue(3);
+    REQUIRE( queue.GetCapacity() == 4 );
+
+    int value = -1;
+    REQUIRE( queue.Push(-1) );
+    REQUIRE( queue.Steal(value) );
+
+    // wrapped around the ring before growing
+    for (int i = 0; i < 100; i++)
+    {
+        REQUIRE( queue.Push(i) );
+    }
+    REQUIRE( queue.GetSize() == 100 );
+    REQUIRE( queue.GetCapacity() == 128 );
+
+    for (int i = 0; i < 50; i++)
+    {
+        REQUIRE( queue.Steal(value) );
+        REQUIRE( value == i );
+    }
+    for (int i = 99; i >= 50; i--)
+    {
+        REQUIRE( queue.Pop(value) );
+        REQUIRE( value == i );
+    }
+    REQUIRE( queue.IsEmpty() );
+}
+
+
+TEST_CASE("work stealing queue under concurrent steals", "[workstealingqueue]") {
+
+    constexpr int NUM_ITEMS = 200000;
+    constexpr int NUM_THIEVES = 6;
+
+    // small initial capacity, so the buffer grows while thieves are stealing
+    WorkStealingQueue<int> queue(16);
+    std::vector<std::atomic<int>> taken(NUM_ITEMS);
+    std::atomic<bool> done = false;
+    std::atomic<int> numStolen = 0;
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < NUM_THIEVES; t++)
+    {
+        thieves.emplace_back([&]() {
+
+            int value;
+            while (!done.load(std::memory_order_acquire) || !queue.IsEmpty())
+            {
+                if (queue.Steal(value))
+                {
+                    taken[value].fetch_add(1, std::memory_order_relaxed);
+                    numStolen.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    // owner interleaves pushes with pops
+    int numPopped = 0;
+    int numFailedPushes = 0;
+    int value;
+    for (int i = 0; i < NUM_ITEMS; i++)
+    {
+        numFailedPushes += queue.Push(i) ? 0 : 1;
+
+        if (i % 3 == 0 && queue.Pop(value))
+        {
+            taken[value].fetch_add(1, std::memory_order_relaxed);
+            numPopped++;
+        }
+    }
+    while (queue.Pop(value))
+    {
+        taken[value].fetch_add(1, std::memory_order_relaxed);
+        numPopped++;
+    }
+
+    done.store(true, std::memory_order_release);
+    for (std::thread &thief : thieves)
+    {
+        thief.join();
+    }
+
+    REQUIRE( numFailedPushes == 0 );
+
+    // every item is taken exactly once
+    int numDuplicates = 0;
+    int numMissing = 0;
+    for (int i = 0; i < NUM_ITEMS; i++)
+    {
+        numDuplicates += taken[i] > 1 ? 1 : 0;
+        numMissing += taken[i] == 0 ? 1 : 0;
+    }
+    REQUIRE( numDuplicates == 0 );
+    REQUIRE( numMissing == 0 );
+    REQUIRE( numPopped + numStolen == NUM_ITEMS );
+    REQUIRE( numStolen > 0 );
+}
+
+
+TEST_CASE("array of work stealing queues", "[workstealingqueue]") {
+
+    Array<WorkStealingQueue<int>> queues;
+    queues.Reserve(2);
+    queues.EmplaceBack(4);
+    queues.EmplaceBack(4);
+    REQUIRE( queues[1].Push(7) );
+
+    // moves the queues into new storage
+    queues.Reserve(8);
+
+    int value = -1;
+    REQUIRE( queues[1].Steal(value) );
+    REQUIRE( value == 7 );
+    REQUIRE( queues[0].IsEmpty() );
+}
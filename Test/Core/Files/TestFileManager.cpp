@@ -0,0 +1,133 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Files/FileManager.h"
+#include "Core/Files/Files.h"
+#include "Core/Jobs/JobManager.h"
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+
+
+using namespace Atuin;
+
+
+namespace {
+
+std::string TestFile(const char *name) {
+
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+} // anonymous
+
+
+TEST_CASE("async file access on I/O threads", "[filemanager]") {
+
+    JobManager jobManager(2);
+    jobManager.StartUp();
+    FileManager fileManager;
+    fileManager.StartUp();
+
+    std::string fileName = TestFile("atuin_test_async.txt");
+
+    SECTION("continuations run on job workers once the file operation is done")
+    {
+        std::atomic<Size> writeThread = JobManager::EXTERNAL_THREAD;
+        JobID write = fileManager.WriteAsync(fileName, "async content", [&](void*){ writeThread = jobManager.ThisThread(); });
+        jobManager.Wait(write);
+        REQUIRE( writeThread < jobManager.NumThreads() );
+
+        Array<char> buffer;
+        bool read = false;
+        JobID job = fileManager.ReadAsync(fileName, buffer, [](void *data){ *static_cast<bool*>(data) = true; }, &read);
+        jobManager.Wait(job);
+
+        REQUIRE( read );
+        REQUIRE( std::string(buffer.Data(), buffer.GetSize()) == "async content" );
+    }
+    SECTION("requests on the same file keep their order")
+    {
+        fileManager.Write(fileName, "");
+
+        std::string expected;
+        JobID last = -1;
+        for (int i = 0; i < 100; i++)
+        {
+            std::string line = std::to_string(i) + '\n';
+            expected += line;
+            last = fileManager.WriteAsync(fileName, line, Task(), nullptr, std::ios::app);
+        }
+        Array<char> buffer;
+        JobID read = fileManager.ReadAsync(fileName, buffer);
+        jobManager.Wait(last);
+        jobManager.Wait(read);
+
+        REQUIRE( std::string(buffer.Data(), buffer.GetSize()) == expected );
+    }
+
+    fileManager.ShutDown();
+    jobManager.ShutDown();
+    std::filesystem::remove(fileName);
+}
+
+
+TEST_CASE("failed async file access after shut down", "[filemanager]") {
+
+    JobManager jobManager(2);
+    jobManager.StartUp();
+    FileManager fileManager;
+    fileManager.StartUp();
+    fileManager.ShutDown();
+
+    // the request runs on the calling thread, its failure must not keep the continuation from running
+    Array<char> buffer;
+    std::atomic<bool> finished = false;
+    JobID job = fileManager.ReadAsync(TestFile("atuin_test_missing.txt"), buffer, [](void *data){ *static_cast<std::atomic<bool>*>(data) = true; }, &finished);
+    REQUIRE( job >= 0 );
+    jobManager.Wait(job);
+    REQUIRE( finished );
+
+    jobManager.ShutDown();
+}
+
+
+TEST_CASE("async file access without job manager", "[filemanager]") {
+
+    FileManager fileManager;
+    fileManager.StartUp();
+
+    std::string fileName = TestFile("atuin_test_sync.txt");
+
+    int numCalls = 0;
+    REQUIRE( fileManager.WriteAsync(fileName, "sync content", [](void *data){ (*static_cast<int*>(data))++; }, &numCalls) == -1 );
+    REQUIRE( numCalls == 1 );
+
+    Array<char> buffer;
+    REQUIRE( fileManager.ReadAsync(fileName, buffer) == -1 );
+    REQUIRE( std::string(buffer.Data(), buffer.GetSize()) == "sync content" );
+
+    fileManager.ShutDown();
+    std::filesystem::remove(fileName);
+}
+
+
+TEST_CASE("async file access without file manager", "[filemanager]") {
+
+    std::string fileName = TestFile("atuin_test_no_manager.txt");
+
+    // the facade falls back to blocking file access and still calls the continuations
+    Files files;
+    REQUIRE( !files.Ready() );
+
+    int numCalls = 0;
+    REQUIRE( files.WriteAsync(fileName, "no manager", [](void *data){ (*static_cast<int*>(data))++; }, &numCalls) == -1 );
+    REQUIRE( numCalls == 1 );
+
+    Array<char> buffer;
+    REQUIRE( files.ReadAsync(fileName, buffer, [](void *data){ (*static_cast<int*>(data))++; }, &numCalls) == -1 );
+    REQUIRE( numCalls == 2 );
+    REQUIRE( std::string(buffer.Data(), buffer.GetSize()) == "no manager" );
+
+    std::filesystem::remove(fileName);
+}
@@ -0,0 +1,194 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Jobs/Coroutine.h"
+#include "Core/Jobs/JobManager.h"
+#include "Core/Files/FileManager.h"
+#include "Core/Files/Files.h"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+
+using namespace Atuin;
+
+
+namespace {
+
+Coroutine<int> Square(int value) {
+
+    co_return value * value;
+}
+
+
+Coroutine<int> SumOfSquares(int n) {
+
+    int sum = 0;
+    for (int i = 1; i <= n; i++)
+    {
+        sum += co_await Square(i);
+    }
+    co_return sum;
+}
+
+
+Coroutine<int> Throw() {
+
+    throw std::runtime_error("coroutine error");
+    co_return 0;
+}
+
+
+Coroutine<> AddAfterJob(JobID job, std::atomic<int> &value) {
+
+    co_await AwaitJob(job);
+    value += 10;
+}
+
+
+Coroutine<> CountFrames(std::atomic<int> &frames, int numFrames) {
+
+    for (int i = 0; i < numFrames; i++)
+    {
+        co_await AwaitNextFrame();
+        frames++;
+    }
+}
+
+
+Coroutine<std::string> ReadFile(std::string fileName) {
+
+    Array<char> buffer;
+    co_await Files().AwaitRead(fileName, buffer);
+    co_return std::string(buffer.Data(), buffer.GetSize());
+}
+
+} // anonymous
+
+
+TEST_CASE("coroutines without job manager", "[coroutine]") {
+
+    SECTION("awaited coroutines run inline")
+    {
+        Coroutine<int> sum = SumOfSquares(4);
+        REQUIRE( sum.Get() == 30 );
+    }
+    SECTION("exceptions are rethrown by Get")
+    {
+        Coroutine<int> error = Throw();
+        REQUIRE_THROWS_AS( error.Get(), std::runtime_error );
+    }
+    SECTION("awaitables continue right away")
+    {
+        std::atomic<int> value = 0;
+        Coroutine<> add = AddAfterJob(-1, value);
+        add.Wait();
+        REQUIRE( value == 10 );
+    }
+    SECTION("file reads happen on the calling thread")
+    {
+        std::string fileName = (std::filesystem::temp_directory_path() / "atuin_test_coroutine_inline.txt").string();
+        Files().WriteAsync(fileName, "inline content");
+
+        Coroutine<std::string> read = ReadFile(fileName);
+        REQUIRE( read.Get() == "inline content" );
+
+        std::filesystem::remove(fileName);
+    }
+}
+
+
+TEST_CASE("coroutines on the job manager", "[coroutine]") {
+
+    JobManager jobManager(2);
+    jobManager.StartUp();
+
+    SECTION("awaiting other coroutines")
+    {
+        Coroutine<int> sum = SumOfSquares(10);
+        sum.Start();
+        REQUIRE( sum.Get() == 385 );
+    }
+    SECTION("exceptions reach the awaiting coroutine")
+    {
+        auto catchError = []() -> Coroutine<bool> {
+
+            try
+            {
+                co_await Throw();
+            }
+            catch (const std::runtime_error&)
+            {
+                co_return true;
+            }
+            co_return false;
+        };
+
+        Coroutine<bool> caught = catchError();
+        REQUIRE( caught.Get() );
+    }
+    SECTION("awaiting jobs")
+    {
+        std::atomic<int> value = 0;
+        std::atomic<bool> blocked = true;
+        JobID job = jobManager.CreateJob( [&](void*){
+
+            while (blocked)
+            {
+                std::this_thread::yield();
+            }
+            value = 1;
+        }, nullptr);
+        jobManager.Run(job);
+
+        Coroutine<> add = AddAfterJob(job, value);
+        add.Start();
+
+        blocked = false;
+        add.Wait();
+        REQUIRE( value == 11 );
+    }
+    SECTION("awaiting the next frame")
+    {
+        std::atomic<int> frames = 0;
+        Coroutine<> count = CountFrames(frames, 3);
+        count.Start();
+
+        for (int frame = 1; frame <= 3; frame++)
+        {
+            // the coroutine might not have reached AwaitNextFrame() yet, so frames are started until it continues
+            auto start = std::chrono::steady_clock::now();
+            while (frames < frame && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+            {
+                jobManager.BeginFrame();
+                std::this_thread::yield();
+            }
+            REQUIRE( frames == frame );
+
+            // no progress without a new frame
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            REQUIRE( frames == frame );
+        }
+        count.Wait();
+    }
+    SECTION("awaiting file reads")
+    {
+        FileManager fileManager;
+        fileManager.StartUp();
+
+        std::string fileName = (std::filesystem::temp_directory_path() / "atuin_test_coroutine.txt").string();
+        fileManager.Write(fileName, "coroutine content");
+
+        Coroutine<std::string> read = ReadFile(fileName);
+        read.Start();
+        REQUIRE( read.Get() == "coroutine content" );
+
+        fileManager.ShutDown();
+        std::filesystem::remove(fileName);
+    }
+
+    jobManager.ShutDown();
+}
@@ -0,0 +1,95 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Jobs/CpuTopology.h"
+#include "Core/Jobs/JobManager.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+
+using namespace Atuin;
+
+
+TEST_CASE("cpu topology detection", "[cputopology]") {
+
+    CpuTopology topology = CpuTopology::Detect();
+
+    REQUIRE( topology.NumPhysicalCores() >= 1 );
+    REQUIRE( topology.NumLogicalCpus() >= topology.NumPhysicalCores() );
+
+    for (const PhysicalCore &core : topology.Cores())
+    {
+        REQUIRE( !core.logicalCpus.IsEmpty() );
+    }
+
+    SECTION("pin order lists every logical cpu once, one per core first")
+    {
+        Array<U32> order = topology.PinOrder();
+        REQUIRE( order.GetSize() == topology.NumLogicalCpus() );
+
+        std::vector<U32> sorted;
+        for (U32 cpu : order)
+        {
+            sorted.push_back(cpu);
+        }
+        std::sort(sorted.begin(), sorted.end());
+        REQUIRE( std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end() );
+
+        for (Size i = 0; i < topology.NumPhysicalCores(); i++)
+        {
+            REQUIRE( order[i] == topology.Cores()[i].logicalCpus[0] );
+        }
+    }
+}
+
+
+#ifdef __linux__
+
+TEST_CASE("thread names are set and truncated", "[cputopology]") {
+
+    char name[16] = {};
+
+    std::thread thread( [&name]()
+    {
+        CpuTopology::SetCurrentThreadName("Atuin Worker with a long name");
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+    });
+    thread.join();
+
+    REQUIRE( std::string(name) == "Atuin Worker wi" );
+}
+
+
+TEST_CASE("threads can be pinned to the first cpu of the pin order", "[cputopology]") {
+
+    CpuTopology topology = CpuTopology::Detect();
+    U32 cpu = topology.PinOrder()[0];
+
+    bool pinned = false;
+    int runsOn = -1;
+    std::thread thread( [&]()
+    {
+        pinned = CpuTopology::PinCurrentThread(cpu);
+        runsOn = sched_getcpu();
+    });
+    thread.join();
+
+    REQUIRE( pinned );
+    REQUIRE( runsOn == (int)cpu );
+}
+
+#endif
+
+
+TEST_CASE("job manager defaults to one worker per physical core", "[cputopology]") {
+
+    JobManager jobManager;
+
+    Size expected = std::max(jobManager.Topology().NumPhysicalCores(), (Size)2) - 1;
+    REQUIRE( jobManager.NumThreads() == expected + 1 );
+}
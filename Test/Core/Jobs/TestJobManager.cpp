@@ -0,0 +1,397 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Jobs/JobManager.h"
+#include "Core/Jobs/Jobs.h"
+#include "Core/Config/ConfigManager.h"
+#include "Core/Memory/MemoryTag.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+
+using namespace Atuin;
+
+
+TEST_CASE("more jobs in flight than job slots", "[jobmanager]") {
+
+    JobManager jobManager(3);
+    jobManager.StartUp();
+
+    // three times MAX_JOBS_PER_FRAME children under a single parent
+    constexpr int NUM_JOBS = 3 * 4096;
+    std::atomic<int> counter = 0;
+
+    JobID parent = jobManager.CreateJob( [](void*){}, nullptr);
+    for (int i = 0; i < NUM_JOBS; i++)
+    {
+        JobID child = jobManager.CreateJob( [&counter](void*){ counter.fetch_add(1, std::memory_order_relaxed); }, nullptr, parent);
+        jobManager.Run(child);
+    }
+    jobManager.Run(parent);
+    jobManager.Wait(parent);
+
+    REQUIRE( counter == NUM_JOBS );
+
+    jobManager.ShutDown();
+}
+
+
+TEST_CASE("job ids of finished jobs stay finished", "[jobmanager]") {
+
+    JobManager jobManager(1);
+    jobManager.StartUp();
+
+    int value = 0;
+    JobID first = jobManager.CreateJob( [&value](void*){ value = 1; }, nullptr);
+    jobManager.Run(first);
+    jobManager.Wait(first);
+    REQUIRE( value == 1 );
+
+    // the next job reuses the slot of the first one with a new generation
+    JobID second = jobManager.CreateJob( [&value](void*){ value = 2; }, nullptr);
+    REQUIRE( second != first );
+    REQUIRE( (second & 0xFFFFFFFF) == (first & 0xFFFFFFFF) );
+
+    // waiting on the stale id must not wait for the job that reuses its slot
+    jobManager.Wait(first);
+
+    jobManager.Run(second);
+    jobManager.Wait(second);
+    REQUIRE( value == 2 );
+
+    jobManager.ShutDown();
+}
+
+
+TEST_CASE("parallel for covers the range exactly once", "[jobmanager]") {
+
+    JobManager jobManager(3);
+    jobManager.StartUp();
+
+    constexpr Size N = 100000;
+    std::vector<std::atomic<int>> visits(N);
+
+    SECTION("automatic grain size")
+    {
+        jobManager.ParallelFor(0, N, [&visits](Size i){ visits[i].fetch_add(1, std::memory_order_relaxed); });
+    }
+    SECTION("fixed grain size and subranges")
+    {
+        std::atomic<Size> numRanges = 0;
+        std::atomic<Size> numTooLarge = 0;
+        jobManager.ParallelRange(0, N, [&](Size first, Size last){
+
+            numTooLarge.fetch_add(last - first > 1000 ? 1 : 0, std::memory_order_relaxed);
+            numRanges.fetch_add(1, std::memory_order_relaxed);
+            for (Size i = first; i < last; i++)
+            {
+                visits[i].fetch_add(1, std::memory_order_relaxed);
+            }
+        }, 1000);
+
+        REQUIRE( numTooLarge == 0 );
+        REQUIRE( numRanges >= N / 1000 );
+    }
+
+    int numWrong = 0;
+    for (Size i = 0; i < N; i++)
+    {
+        numWrong += visits[i] != 1 ? 1 : 0;
+    }
+    REQUIRE( numWrong == 0 );
+
+    // empty ranges do nothing
+    bool called = false;
+    jobManager.ParallelFor(5, 5, [&called](Size){ called = true; });
+    REQUIRE( !called );
+
+    jobManager.ShutDown();
+}
+
+
+TEST_CASE("jobs waiting on other jobs", "[jobmanager]") {
+
+    JobManager jobManager(3);
+    jobManager.StartUp();
+
+    SECTION("every job waits on its children")
+    {
+        std::atomic<int> counter = 0;
+
+        JobID root = jobManager.CreateJob( [&](void*){
+
+            JobID children[8];
+            for (JobID &child : children)
+            {
+                child = jobManager.CreateJob( [&](void*){
+
+                    JobID grandChild = jobManager.CreateJob( [&counter](void*){ counter.fetch_add(1, std::memory_order_relaxed); }, nullptr);
+                    jobManager.Run(grandChild);
+                    jobManager.Wait(grandChild);
+
+                    counter.fetch_add(1, std::memory_order_relaxed);
+                }, nullptr);
+                jobManager.Run(child);
+            }
+            for (JobID child : children)
+            {
+                jobManager.Wait(child);
+            }
+        }, nullptr);
+
+        jobManager.Run(root);
+        jobManager.Wait(root);
+        REQUIRE( counter == 16 );
+    }
+    SECTION("chain of waiting jobs")
+    {
+        // every level suspends its fiber until the next level has finished
+        std::function<void(int)> level = [&](int depth) {
+
+            if (depth == 0)
+            {
+                return;
+            }
+            JobID next = jobManager.CreateJob( [&level, depth](void*){ level(depth - 1); }, nullptr);
+            jobManager.Run(next);
+            jobManager.Wait(next);
+        };
+
+        std::atomic<bool> done = false;
+        JobID first = jobManager.CreateJob( [&](void*){ level(12); done = true; }, nullptr);
+        jobManager.Run(first);
+        jobManager.Wait(first);
+        REQUIRE( done );
+    }
+
+    jobManager.ShutDown();
+}
+
+
+TEST_CASE("memory tag scopes stay with their job across waits", "[jobmanager]") {
+
+    JobManager jobManager(1);
+    jobManager.StartUp();
+
+    // both jobs open a scope and wait, the worker runs the second one while the first is suspended
+    JobID gate = jobManager.CreateJob( [](void*){}, nullptr);
+    std::atomic<int> numWaiting = 0;
+    std::atomic<int> numWrongTag = 0;
+
+    MemoryTag tags[] = { MemoryTag::SCENE, MemoryTag::GRAPHICS };
+    auto taggedJob = [&](MemoryTag *tagPtr) {
+
+        return jobManager.CreateJob( [&](void *data){
+
+            MemoryTag tag = *static_cast<MemoryTag*>(data);
+            {
+                MemoryTagScope scope(tag);
+                numWaiting++;
+                jobManager.Wait(gate);
+                numWrongTag += MemoryTagScope::Current() != tag ? 1 : 0;
+            }
+            numWrongTag += MemoryTagScope::Current() != MemoryTag::GENERAL ? 1 : 0;
+        }, tagPtr);
+    };
+    JobID scene = taggedJob(&tags[0]);
+    JobID graphics = taggedJob(&tags[1]);
+    jobManager.Run(scene);
+    jobManager.Run(graphics);
+
+    auto start = std::chrono::steady_clock::now();
+    while (numWaiting < 2 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+    {
+        std::this_thread::yield();
+    }
+    jobManager.Run(gate);
+    jobManager.Wait(scene);
+    jobManager.Wait(graphics);
+
+    REQUIRE( numWrongTag == 0 );
+    REQUIRE( MemoryTagScope::Current() == MemoryTag::GENERAL );
+
+    jobManager.ShutDown();
+}
+
+
+TEST_CASE("parked workers are woken for new jobs", "[jobmanager]") {
+
+    JobManager jobManager(2);
+    jobManager.StartUp();
+
+    for (int round = 0; round < 3; round++)
+    {
+        // long enough for both workers to spin out and park
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        // the main thread does not wait in the job system, so only a worker can run the job
+        std::atomic<Size> thread = jobManager.NumThreads();
+        JobID job = jobManager.CreateJob( [&](void*){ thread = jobManager.ThisThread(); }, nullptr);
+        jobManager.Run(job);
+
+        auto start = std::chrono::steady_clock::now();
+        while (thread == jobManager.NumThreads() && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+        {
+            std::this_thread::yield();
+        }
+        REQUIRE( thread < jobManager.NumThreads() - 1 );
+    }
+
+    jobManager.ShutDown();
+}
+
+
+TEST_CASE("job priorities", "[jobmanager]") {
+
+    SECTION("higher priorities run first")
+    {
+        JobManager jobManager(1);
+        jobManager.StartUp();
+
+        // keep the only worker busy while the jobs are queued, the main thread does not run jobs since it does not wait
+        std::atomic<bool> blocked = true;
+        JobID blocker = jobManager.CreateJob( [&blocked](void*){ while (blocked) { std::this_thread::yield(); } }, nullptr);
+        jobManager.Run(blocker);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        std::vector<int> order;
+        std::atomic<int> numDone = 0;
+        JobID background = jobManager.CreateJob( [&](void*){ order.push_back(2); numDone++; }, nullptr, -1, JobPriority::BACKGROUND);
+        JobID normal = jobManager.CreateJob( [&](void*){ order.push_back(1); numDone++; }, nullptr, -1, JobPriority::NORMAL);
+        JobID high = jobManager.CreateJob( [&](void*){ order.push_back(0); numDone++; }, nullptr, -1, JobPriority::HIGH);
+        jobManager.Run(background);
+        jobManager.Run(normal);
+        jobManager.Run(high);
+
+        blocked = false;
+        while (numDone < 3)
+        {
+            std::this_thread::yield();
+        }
+        REQUIRE( order == std::vector<int>{0, 1, 2} );
+
+        jobManager.ShutDown();
+    }
+    SECTION("parallel for subranges keep their priority")
+    {
+        JobManager jobManager(1);
+        jobManager.StartUp();
+
+        std::atomic<bool> blocked = true;
+        std::atomic<bool> started = false;
+        JobID blocker = jobManager.CreateJob( [&](void*){ started = true; while (blocked) { std::this_thread::yield(); } }, nullptr);
+        jobManager.Run(blocker);
+        while (!started)
+        {
+            std::this_thread::yield();
+        }
+
+        // every index queues a NORMAL job, the main thread pops its newest job first, so only priorities keep these behind the subranges
+        std::atomic<int> numNormalRun = 0;
+        std::atomic<int> numLate = 0;
+        JobID normals = jobManager.CreateJob( [](void*){}, nullptr);
+        jobManager.ParallelFor(0, 16, [&](Size){
+
+            numLate += numNormalRun > 0 ? 1 : 0;
+            jobManager.Run( jobManager.CreateJob( [&numNormalRun](void*){ numNormalRun++; }, nullptr, normals, JobPriority::NORMAL) );
+        }, 1, JobPriority::HIGH);
+
+        REQUIRE( numLate == 0 );
+
+        blocked = false;
+        jobManager.Run(normals);
+        jobManager.Wait(normals);
+        jobManager.Wait(blocker);
+        REQUIRE( numNormalRun == 16 );
+
+        jobManager.ShutDown();
+    }
+    SECTION("background jobs are throttled")
+    {
+        JobManager jobManager(3);
+        jobManager.StartUp();
+
+        // BACKGROUND_JOB_THREADS defaults to 1
+        std::atomic<int> numRunning = 0;
+        std::atomic<int> maxRunning = 0;
+        JobID parent = jobManager.CreateJob( [](void*){}, nullptr);
+        for (int i = 0; i < 4; i++)
+        {
+            JobID job = jobManager.CreateJob( [&](void*){
+
+                int running = ++numRunning;
+                int max = maxRunning;
+                while (running > max && !maxRunning.compare_exchange_weak(max, running)) {}
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                numRunning--;
+            }, nullptr, parent, JobPriority::BACKGROUND);
+            jobManager.Run(job);
+        }
+        jobManager.Run(parent);
+        jobManager.Wait(parent);
+
+        REQUIRE( maxRunning == 1 );
+
+        jobManager.ShutDown();
+    }
+}
+
+
+TEST_CASE("failed start up leaves the job manager unpublished", "[jobmanager]") {
+
+    // fiber stacks larger than the address space cannot be mapped
+    ConfigManager config;
+    config.SetCVar("Multithreading", "FIBER_STACK_SIZE", "1125899906842624");
+
+    JobManager jobManager(2);
+    REQUIRE_THROWS( jobManager.StartUp() );
+    config.SetCVar("Multithreading", "FIBER_STACK_SIZE", "262144");
+
+    REQUIRE( !Jobs().Ready() );
+    REQUIRE( jobManager.ThisThread() == JobManager::EXTERNAL_THREAD );
+    jobManager.ShutDown();
+}
+
+
+TEST_CASE("threads the job manager does not own", "[jobmanager]") {
+
+    JobManager jobManager(2);
+    jobManager.StartUp();
+
+    std::atomic<int> numDone = 0;
+    std::atomic<int> numWrongThread = 0;
+    std::thread external( [&]() {
+
+        if (jobManager.ThisThread() != JobManager::EXTERNAL_THREAD)
+        {
+            numWrongThread++;
+        }
+
+        JobID parent = jobManager.CreateJob( [](void*){}, nullptr);
+        for (int i = 0; i < 64; i++)
+        {
+            JobID job = jobManager.CreateJob( [&](void*){ 
+
+                if (jobManager.ThisThread() >= jobManager.NumThreads())
+                {
+                    numWrongThread++;
+                }
+                numDone++;
+            }, nullptr, parent, i % 2 == 0 ? JobPriority::HIGH : JobPriority::BACKGROUND);
+            jobManager.Run(job);
+        }
+        jobManager.Run(parent);
+        jobManager.Wait(parent);
+    });
+    external.join();
+
+    REQUIRE( numDone == 64 );
+    REQUIRE( numWrongThread == 0 );
+
+    // the main thread is external again once its job manager has shut down
+    jobManager.ShutDown();
+    REQUIRE( jobManager.ThisThread() == JobManager::EXTERNAL_THREAD );
+}
@@ -0,0 +1,143 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Jobs/JobManager.h"
+#include "Core/Jobs/JobTrace.h"
+#include "Core/DataStructures/Json.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+
+using namespace Atuin;
+
+
+namespace {
+
+// number of trace events per name in a Chrome trace JSON
+Size CountEvents(const std::string &trace, const std::string &name) {
+
+    Json json = Json::Load(trace);
+
+    Size count = 0;
+    for (const Json &event : json.At("traceEvents").GetList())
+    {
+        if (event.At("name").ToString() == name)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+} // anonymous
+
+
+TEST_CASE("job tracer ring buffers", "[jobtrace]") {
+
+    JobTracer tracer;
+    tracer.Init(2, 4);
+
+    for (U64 i = 0; i < 6; i++)
+    {
+        tracer.Record(0, TraceEvent{ i * 1000, i * 1000 + 500, (I64)i, 1, TraceEventType::JOB });
+    }
+    tracer.Record(1, TraceEvent{ 100, 100, 7, 0, TraceEventType::STEAL });
+    tracer.Record(1, TraceEvent{ 200, 900, -1, 0, TraceEventType::IDLE });
+
+    // the oldest two events of thread 0 are overwritten
+    REQUIRE( tracer.NumEvents(0) == 4 );
+    REQUIRE( tracer.NumEvents(1) == 2 );
+    REQUIRE( tracer.NumEvents(0, TraceEventType::JOB) == 4 );
+    REQUIRE( tracer.NumEvents(1, TraceEventType::STEAL) == 1 );
+    REQUIRE( tracer.NumEvents(1, TraceEventType::IDLE) == 1 );
+    REQUIRE( tracer.NumEvents(1, TraceEventType::JOB) == 0 );
+
+    Array<std::string> threadNames(2);
+    threadNames.EmplaceBack("Worker");
+    threadNames.EmplaceBack("Main");
+
+    std::string trace = tracer.ExportChromeJson(threadNames);
+    REQUIRE( CountEvents(trace, "thread_name") == 2 );
+    REQUIRE( CountEvents(trace, "Job NORMAL") == 4 );
+    REQUIRE( CountEvents(trace, "Steal") == 1 );
+    REQUIRE( CountEvents(trace, "Idle") == 1 );
+
+    Json json = Json::Load(trace);
+    const Json &oldest = json.At("traceEvents")[2];
+    REQUIRE( oldest.At("ts").ToFloat() == Approx(2.0) );
+    REQUIRE( oldest.At("dur").ToFloat() == Approx(0.5) );
+
+    tracer.Clear();
+    REQUIRE( tracer.NumEvents(0) == 0 );
+}
+
+
+TEST_CASE("job manager traces executed jobs", "[jobtrace]") {
+
+    JobManager jobManager(2);
+    jobManager.StartUp();
+
+    // nothing is recorded before StartTrace()
+    JobID untraced = jobManager.CreateJob( [](void*){}, nullptr);
+    jobManager.Run(untraced);
+    jobManager.Wait(untraced);
+    REQUIRE( CountEvents(jobManager.ExportTrace(), "Job NORMAL") == 0 );
+
+    jobManager.StartTrace();
+
+    // waiting children split their parent into two segments
+    JobID root = jobManager.CreateJob( [&](void*){
+
+        JobID parent = jobManager.CreateJob( [](void*){}, nullptr);
+        for (int i = 0; i < 16; i++)
+        {
+            jobManager.Run( jobManager.CreateJob( [](void*){}, nullptr, parent, JobPriority::HIGH) );
+        }
+        jobManager.Run(parent);
+        jobManager.Wait(parent);
+    }, nullptr);
+    jobManager.Run(root);
+    jobManager.Wait(root);
+
+    jobManager.StopTrace();
+    std::string trace = jobManager.ExportTrace();
+
+    REQUIRE( CountEvents(trace, "Job HIGH") == 16 );
+    Size numNormal = CountEvents(trace, "Job NORMAL");
+    REQUIRE( numNormal >= 2 );
+    REQUIRE( numNormal <= 3 );
+    REQUIRE( CountEvents(trace, "thread_name") == jobManager.NumThreads() );
+
+    // the per type counts agree with the export
+    Size numJobEvents = 0;
+    Size numSteals = 0;
+    for (Size thread = 0; thread < jobManager.NumThreads(); thread++)
+    {
+        numJobEvents += jobManager.Tracer().NumEvents(thread, TraceEventType::JOB);
+        numSteals += jobManager.Tracer().NumEvents(thread, TraceEventType::STEAL);
+    }
+    REQUIRE( numJobEvents == 16 + numNormal );
+    REQUIRE( numSteals == CountEvents(trace, "Steal") );
+
+    // a job that stops the trace and then waits records only its final segment
+    jobManager.StartTrace();
+    JobID stopping = jobManager.CreateJob( [&](void*){
+
+        jobManager.StopTrace();
+        JobID child = jobManager.CreateJob( [](void*){ std::this_thread::sleep_for(std::chrono::milliseconds(1)); }, nullptr);
+        jobManager.Run(child);
+        jobManager.Wait(child);
+    }, nullptr);
+    jobManager.Run(stopping);
+    jobManager.Wait(stopping);
+
+    numJobEvents = 0;
+    for (Size thread = 0; thread < jobManager.NumThreads(); thread++)
+    {
+        numJobEvents += jobManager.Tracer().NumEvents(thread, TraceEventType::JOB);
+    }
+    REQUIRE( numJobEvents == 1 );
+
+    jobManager.ShutDown();
+}
@@ -0,0 +1,56 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Jobs/Task.h"
+
+#include <memory>
+#include <utility>
+
+
+using namespace Atuin;
+
+
+TEST_CASE("task invokes its callable with the job data", "[task]") {
+
+    Task empty;
+    REQUIRE( !empty );
+
+    int offset = 10;
+    Task task = [offset](void *data){ *static_cast<int*>(data) += offset; };
+    REQUIRE( task );
+
+    int value = 1;
+    task(&value);
+    REQUIRE( value == 11 );
+}
+
+
+TEST_CASE("task moves and destroys its captures", "[task]") {
+
+    auto counter = std::make_shared<int>(0);
+
+    {
+        Task task = [counter](void*){ (*counter)++; };
+        REQUIRE( counter.use_count() == 2 );
+
+        // moving transfers the capture instead of copying it
+        Task other = std::move(task);
+        REQUIRE( !task );
+        REQUIRE( counter.use_count() == 2 );
+
+        other(nullptr);
+        REQUIRE( *counter == 1 );
+
+        task = std::move(other);
+        task(nullptr);
+        REQUIRE( *counter == 2 );
+
+        // clearing releases the capture right away
+        task = nullptr;
+        REQUIRE( counter.use_count() == 1 );
+
+        task = [counter](void*){};
+        REQUIRE( counter.use_count() == 2 );
+    }
+
+    REQUIRE( counter.use_count() == 1 );
+}
@@ -0,0 +1,66 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Jobs/TaskGraph.h"
+
+#include <atomic>
+#include <vector>
+
+
+using namespace Atuin;
+
+
+TEST_CASE("task graph respects its edges", "[taskgraph]") {
+
+    JobManager jobManager(3);
+    jobManager.StartUp();
+
+    // diamond a -> (b, c) -> d plus an unrelated node e
+    std::atomic<int> clock = 0;
+    std::vector<int> finishedAt(5, -1);
+    TaskGraph graph;
+
+    auto node = [&](int i) {
+        return graph.AddNode( [&finishedAt, &clock, i](void*){ finishedAt[i] = clock++; } );
+    };
+    TaskNodeID a = node(0);
+    TaskNodeID b = node(1);
+    TaskNodeID c = node(2);
+    TaskNodeID d = node(3);
+    node(4);
+
+    graph.AddEdge(a, b);
+    graph.AddEdge(a, c);
+    graph.AddEdge(b, d);
+    graph.AddEdge(c, d);
+
+    // the same graph runs once per frame
+    for (int frame = 0; frame < 50; frame++)
+    {
+        clock = 0;
+        graph.Execute();
+
+        REQUIRE( !graph.IsRunning() );
+        REQUIRE( finishedAt[4] >= 0 );
+        REQUIRE( finishedAt[0] < finishedAt[1] );
+        REQUIRE( finishedAt[0] < finishedAt[2] );
+        REQUIRE( finishedAt[1] < finishedAt[3] );
+        REQUIRE( finishedAt[2] < finishedAt[3] );
+    }
+
+    jobManager.ShutDown();
+}
+
+
+TEST_CASE("task graph without job manager", "[taskgraph]") {
+
+    // nodes run one after another in an order that respects the edges
+    std::vector<int> order;
+    int zero = 0;
+    TaskGraph graph;
+    TaskNodeID second = graph.AddNode( [&order](void*){ order.push_back(1); } );
+    TaskNodeID first = graph.AddNode( [&order](void *data){ order.push_back(*static_cast<int*>(data)); }, &zero );
+    graph.AddEdge(first, second);
+
+    graph.Execute();
+    REQUIRE( order == std::vector<int>{0, 1} );
+}
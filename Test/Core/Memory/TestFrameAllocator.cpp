@@ -0,0 +1,66 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Memory/FrameAllocator.h"
+#include "Core/DataStructures/Array.h"
+
+
+using namespace Atuin;
+
+
+TEST_CASE("frame allocator cycles buffers", "[frameallocator]") {
+
+    FrameAllocator allocator(1_KB, 2);
+
+    void *a = allocator.Allocate(256, 8);
+    void *b = allocator.Allocate(256, 8);
+    REQUIRE( reinterpret_cast<UPtr>(b) == reinterpret_cast<UPtr>(a) + 256 );
+    REQUIRE( allocator.UsedMemory() == 512 );
+
+    // free does not release anything
+    allocator.Free(a);
+    REQUIRE( allocator.UsedMemory() == 512 );
+
+    // memory of the previous frame stays valid in the next one
+    allocator.BeginFrame();
+    REQUIRE( allocator.CurrentBuffer() == 1 );
+    void *c = allocator.Allocate(256, 8);
+    REQUIRE( (c < a || c >= reinterpret_cast<void*>(reinterpret_cast<UPtr>(a) + 1_KB)) );
+    REQUIRE( allocator.UsedMemory() == 768 );
+
+    // cycling back to the first buffer releases it as a whole
+    allocator.BeginFrame();
+    REQUIRE( allocator.CurrentBuffer() == 0 );
+    REQUIRE( allocator.UsedMemory() == 256 );
+    REQUIRE( allocator.Allocate(256, 8) == a );
+
+    REQUIRE_THROWS_AS( allocator.Allocate(2_KB, 8), std::overflow_error );
+
+    allocator.Clear();
+    REQUIRE( allocator.UsedMemory() == 0 );
+    REQUIRE( allocator.CurrentBuffer() == 0 );
+}
+
+
+TEST_CASE("array in frame memory", "[frameallocator]") {
+
+    FrameAllocator allocator(1_MB, 2);
+
+    Array<int> arr(&allocator);
+    for (int i = 0; i < 1000; i++)
+    {
+        arr.PushBack(i);
+    }
+
+    // growing the array keeps using the frame allocator
+    REQUIRE( allocator.UsedMemory() >= 1000 * sizeof(int) );
+    for (int i = 0; i < 1000; i++)
+    {
+        REQUIRE( arr[i] == i );
+    }
+
+    Array<int> moved( std::move(arr) );
+    moved.Resize(5000, 1);
+    REQUIRE( moved[999] == 999 );
+    REQUIRE( moved[4999] == 1 );
+    REQUIRE( allocator.UsedMemory() >= 6000 * sizeof(int) );
+}
@@ -0,0 +1,185 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Memory/FreeTreeAllocator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+
+using namespace Atuin;
+
+
+namespace {
+
+constexpr Size NUM_BLOCKS = 4096;
+constexpr Size BLOCK_SIZE = 64;
+
+std::vector<void*> AllocateBlocks(FreeTreeAllocator &allocator) {
+
+    std::vector<void*> blocks;
+    for (Size i = 0; i < NUM_BLOCKS; i++)
+    {
+        blocks.push_back( allocator.Allocate(BLOCK_SIZE, 8) );
+    }
+
+    return blocks;
+}
+
+// AVL trees with n nodes are at most 1.44 * log2(n + 2) high, an unbalanced tree of sorted inserts is n high
+bool IsBalanced(const FreeTreeAllocator &allocator) {
+
+    Size numNodes = allocator.NumFreeRegions();
+    return (double)allocator.TreeHeight() <= 1.44 * std::log2( (double)numNodes + 2.0 );
+}
+
+// the tree must stay balanced after every single free, not only once everything has merged again
+// returns the largest number of free regions seen meanwhile
+Size FreeBlocks(FreeTreeAllocator &allocator, const std::vector<void*> &blocks, const std::vector<Size> &order) {
+
+    Size numUnbalanced = 0;
+    Size maxRegions = 0;
+    for (Size idx : order)
+    {
+        allocator.Free( blocks[idx] );
+        numUnbalanced += IsBalanced(allocator) ? 0 : 1;
+        maxRegions = std::max(maxRegions, allocator.NumFreeRegions());
+    }
+
+    REQUIRE( numUnbalanced == 0 );
+
+    return maxRegions;
+}
+
+// all memory must be merged back into a single region
+void RequireFullyMerged(FreeTreeAllocator &allocator) {
+
+    REQUIRE( allocator.UsedMemory() == 0 );
+    REQUIRE_NOTHROW( allocator.Free( allocator.Allocate(allocator.TotalMemory() - 64, 8) ) );
+}
+
+} // namespace
+
+
+TEST_CASE("free tree allocate and free", "[freetreeallocator]") {
+
+    FreeTreeAllocator allocator(1_MB);
+
+    void *a = allocator.Allocate(10, 8);
+    void *b = allocator.Allocate(1000, 64);
+    void *c = allocator.Allocate(100000, 16);
+
+    REQUIRE( reinterpret_cast<UPtr>(a) % 8 == 0 );
+    REQUIRE( reinterpret_cast<UPtr>(b) % 64 == 0 );
+    REQUIRE( reinterpret_cast<UPtr>(c) % 16 == 0 );
+
+    allocator.Free(b);
+    allocator.Free(a);
+    allocator.Free(c);
+
+    RequireFullyMerged(allocator);
+}
+
+TEST_CASE("free tree adversarial free orders", "[freetreeallocator]") {
+
+    FreeTreeAllocator allocator(1_MB);
+    auto blocks = AllocateBlocks(allocator);
+
+    std::vector<Size> order;
+    // the interleaved orders build a large tree of unmerged regions before the gaps are freed
+    Size minPeakRegions = 1;
+    
+    SECTION("ascending addresses")
+    {
+        for (Size i = 0; i < NUM_BLOCKS; i++)
+        {
+            order.push_back(i);
+        }
+    }
+    SECTION("descending addresses")
+    {
+        for (Size i = NUM_BLOCKS; i > 0; i--)
+        {
+            order.push_back(i - 1);
+        }
+    }
+    SECTION("every other block ascending, then the gaps descending")
+    {
+        // creates NUM_BLOCKS / 2 unmerged free nodes inserted in address order
+        minPeakRegions = NUM_BLOCKS / 2;
+        for (Size i = 0; i < NUM_BLOCKS; i += 2)
+        {
+            order.push_back(i);
+        }
+        for (Size i = NUM_BLOCKS - 1; i < NUM_BLOCKS; i -= 2)
+        {
+            order.push_back(i);
+        }
+    }
+    SECTION("every other block descending, then the gaps ascending")
+    {
+        minPeakRegions = NUM_BLOCKS / 2;
+        for (Size i = NUM_BLOCKS - 1; i < NUM_BLOCKS; i -= 2)
+        {
+            order.push_back(i);
+        }
+        for (Size i = 0; i < NUM_BLOCKS; i += 2)
+        {
+            order.push_back(i);
+        }
+    }
+    SECTION("random order")
+    {
+        for (Size i = 0; i < NUM_BLOCKS; i++)
+        {
+            order.push_back(i);
+        }
+        std::shuffle(order.begin(), order.end(), std::mt19937(42));
+    }
+
+    REQUIRE( FreeBlocks(allocator, blocks, order) >= minPeakRegions );
+    RequireFullyMerged(allocator);
+}
+
+TEST_CASE("free tree reuses fragmented regions", "[freetreeallocator]") {
+
+    FreeTreeAllocator allocator(1_MB);
+    auto blocks = AllocateBlocks(allocator);
+
+    // free every other block in address order, leaving many small unmerged regions
+    for (Size i = 0; i < NUM_BLOCKS; i += 2)
+    {
+        allocator.Free(blocks[i]);
+    }
+
+    // every freed region fits a new block of the same size
+    for (Size i = 0; i < NUM_BLOCKS; i += 2)
+    {
+        blocks[i] = allocator.Allocate(BLOCK_SIZE, 8);
+        REQUIRE( blocks[i] != nullptr );
+    }
+
+    std::vector<Size> order;
+    for (Size i = 0; i < NUM_BLOCKS; i++)
+    {
+        order.push_back(i);
+    }
+    FreeBlocks(allocator, blocks, order);
+    RequireFullyMerged(allocator);
+}
+
+TEST_CASE("free tree allocates from the lowest fitting region", "[freetreeallocator]") {
+
+    FreeTreeAllocator allocator(1_MB);
+    auto blocks = AllocateBlocks(allocator);
+
+    // two separate regions of the same size, freed high first, each spans two blocks to leave room for the worst case alignment
+    allocator.Free(blocks[NUM_BLOCKS - 3]);
+    allocator.Free(blocks[NUM_BLOCKS - 2]);
+    allocator.Free(blocks[1]);
+    allocator.Free(blocks[2]);
+
+    REQUIRE( allocator.Allocate(BLOCK_SIZE, 8) == blocks[1] );
+    REQUIRE( allocator.Allocate(BLOCK_SIZE, 8) == blocks[NUM_BLOCKS - 3] );
+}
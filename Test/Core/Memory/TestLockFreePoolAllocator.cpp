@@ -0,0 +1,109 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Memory/LockFreePoolAllocator.h"
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+
+using namespace Atuin;
+
+
+TEST_CASE("lock-free pool allocate and free", "[lockfreepoolallocator]") {
+
+    LockFreePoolAllocator allocator(16, 64);
+
+    std::set<void*> chunks;
+    for (Size i = 0; i < allocator.NumChunks(); i++)
+    {
+        void *mem = allocator.Allocate();
+        REQUIRE( allocator.Owns(mem) );
+        chunks.insert(mem);
+    }
+    REQUIRE( chunks.size() == 16 );
+    REQUIRE( reinterpret_cast<UPtr>(*chunks.rbegin()) - reinterpret_cast<UPtr>(*chunks.begin()) == 15 * 64 );
+    REQUIRE( allocator.UsedMemory() == 16 * 64 );
+
+    REQUIRE( allocator.TryAllocate() == nullptr );
+    REQUIRE_THROWS_AS( allocator.Allocate(), std::overflow_error );
+
+    // most recently freed chunk is reused first
+    void *last = *chunks.rbegin();
+    allocator.Free(last);
+    REQUIRE( allocator.Allocate() == last );
+
+    for (void *mem : chunks)
+    {
+        allocator.Free(mem);
+    }
+    REQUIRE( allocator.UsedMemory() == 0 );
+    REQUIRE( allocator.MaxUsedMemory() == 16 * 64 );
+
+    allocator.Clear();
+    REQUIRE( allocator.Allocate() != nullptr );
+}
+
+
+TEST_CASE("lock-free pool shared between threads", "[lockfreepoolallocator]") {
+
+    constexpr Size NUM_THREADS = 8;
+    constexpr Size NUM_ITERATIONS = 20000;
+    constexpr Size CHUNKS_PER_THREAD = 8;
+
+    LockFreePoolAllocator allocator(NUM_THREADS * CHUNKS_PER_THREAD, 64);
+    std::atomic<Size> numErrors = 0;
+
+    auto work = [&](Size threadId) {
+
+        void *held[CHUNKS_PER_THREAD];
+        for (Size it = 0; it < NUM_ITERATIONS; it++)
+        {
+            // every chunk is owned by exactly one thread, so nobody else may overwrite the marker
+            Size count = it % CHUNKS_PER_THREAD + 1;
+            for (Size i = 0; i < count; i++)
+            {
+                held[i] = allocator.TryAllocate();
+                if (held[i] == nullptr)
+                {
+                    ++numErrors;
+                    count = i;
+                    break;
+                }
+                *static_cast<Size*>(held[i]) = threadId;
+            }
+
+            for (Size i = 0; i < count; i++)
+            {
+                if (*static_cast<Size*>(held[i]) != threadId)
+                {
+                    ++numErrors;
+                }
+                allocator.Free(held[i]);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (Size i = 0; i < NUM_THREADS; i++)
+    {
+        threads.emplace_back(work, i);
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE( numErrors == 0 );
+    REQUIRE( allocator.UsedMemory() == 0 );
+
+    // no chunk got lost or linked twice
+    std::set<void*> chunks;
+    for (Size i = 0; i < allocator.NumChunks(); i++)
+    {
+        chunks.insert( allocator.Allocate() );
+    }
+    REQUIRE( chunks.size() == allocator.NumChunks() );
+    REQUIRE( allocator.TryAllocate() == nullptr );
+}
@@ -0,0 +1,71 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Memory/MemoryManager.h"
+#include "Core/Memory/Memory.h"
+#include "Core/DataStructures/Array.h"
+
+
+using namespace Atuin;
+
+
+TEST_CASE("memory statistics per tag", "[memorymanager]") {
+
+    MemoryManager memoryManager;
+
+    SECTION("allocate and free with a tag")
+    {
+        void *small = memoryManager.Allocate(100, 8, MemoryTag::GRAPHICS);
+        void *large = memoryManager.Allocate(10000, 8, MemoryTag::GRAPHICS);
+
+        MemoryStats stats = memoryManager.GetStats(MemoryTag::GRAPHICS);
+        REQUIRE( stats.numAllocations == 2 );
+        REQUIRE( stats.usedMemory >= 10100 );
+        REQUIRE( stats.peakMemory == stats.usedMemory );
+        REQUIRE( memoryManager.GetStats(MemoryTag::AUDIO).usedMemory == 0 );
+
+        memoryManager.Free(small, MemoryTag::GRAPHICS);
+        memoryManager.Free(large, MemoryTag::GRAPHICS);
+
+        MemoryStats freedStats = memoryManager.GetStats(MemoryTag::GRAPHICS);
+        REQUIRE( freedStats.numAllocations == 0 );
+        REQUIRE( freedStats.usedMemory == 0 );
+        REQUIRE( freedStats.peakMemory == stats.peakMemory );
+    }
+    SECTION("containers take the tag of the current scope")
+    {
+        {
+            MemoryTagScope tagScope(MemoryTag::SCENE);
+
+            Memory memory;
+            REQUIRE( memory.Tag() == MemoryTag::SCENE );
+
+            Array<int> arr;
+            arr.Resize(1000);
+            REQUIRE( memoryManager.GetStats(MemoryTag::SCENE).usedMemory >= 1000 * sizeof(int) );
+        }
+        REQUIRE( MemoryTagScope::Current() == MemoryTag::GENERAL );
+        REQUIRE( memoryManager.GetStats(MemoryTag::SCENE).usedMemory == 0 );
+    }
+}
+
+
+TEST_CASE("relocatable memory is compacted every frame", "[memorymanager]") {
+
+    MemoryManager memoryManager;
+    Memory memory(MemoryTag::GRAPHICS);
+
+    MemoryHandle first = memory.AllocateRelocatable(1000, 16);
+    MemoryHandle second = memory.AllocateRelocatable(1000, 16);
+    REQUIRE( memoryManager.GetStats(MemoryTag::GRAPHICS).usedMemory == 2000 );
+
+    memory.FreeRelocatable(first);
+    REQUIRE( !memory.RelocatableMemory()->IsValid(first) );
+    REQUIRE( memoryManager.GetStats(MemoryTag::GRAPHICS).usedMemory == 1000 );
+    REQUIRE( !memory.RelocatableMemory()->IsCompact() );
+
+    memory.BeginFrame();
+    REQUIRE( memory.RelocatableMemory()->IsCompact() );
+    REQUIRE( memory.RelocatableMemory()->IsValid(second) );
+
+    memory.FreeRelocatable(second);
+}
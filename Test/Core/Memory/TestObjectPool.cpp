@@ -0,0 +1,103 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Memory/ObjectPool.h"
+#include "Core/Memory/FreeListAllocator.h"
+
+#include <set>
+#include <thread>
+#include <vector>
+
+
+using namespace Atuin;
+
+
+namespace {
+
+struct alignas(16) TestObject {
+
+    U64 values[5];
+};
+
+} // namespace
+
+
+TEST_CASE("object pool grows by blocks", "[objectpool]") {
+
+    FreeListAllocator heap(1_MB);
+    {
+        ObjectPool pool(sizeof(TestObject), alignof(TestObject), 16, &heap);
+        REQUIRE( pool.NumBlocks() == 0 );
+        REQUIRE( pool.ObjectSize() == 48 );
+
+        std::vector<void*> objects;
+        for (Size i = 0; i < 40; i++)
+        {
+            void *mem = pool.Allocate();
+            REQUIRE( reinterpret_cast<UPtr>(mem) % alignof(TestObject) == 0 );
+            objects.push_back(mem);
+        }
+        REQUIRE( pool.NumBlocks() == 3 );
+        REQUIRE( pool.UsedMemory() == 40 * 48 );
+
+        // objects of the same block are contiguous
+        for (Size i = 1; i < 16; i++)
+        {
+            REQUIRE( reinterpret_cast<UPtr>(objects[i]) - reinterpret_cast<UPtr>(objects[i-1]) == 48 );
+        }
+
+        int stackObject;
+        REQUIRE( pool.Owns(objects[35]) );
+        REQUIRE( !pool.Owns(&stackObject) );
+
+        // freed objects are reused before a new block is added
+        for (void *mem : objects)
+        {
+            pool.Free(mem);
+        }
+        REQUIRE( pool.UsedMemory() == 0 );
+        for (Size i = 0; i < 48; i++)
+        {
+            pool.Allocate();
+        }
+        REQUIRE( pool.NumBlocks() == 3 );
+    }
+    REQUIRE( heap.UsedMemory() == 0 );
+}
+
+
+TEST_CASE("object pool shared between threads", "[objectpool]") {
+
+    constexpr Size NUM_THREADS = 8;
+    constexpr Size NUM_OBJECTS = 1000;
+
+    ObjectPool pool(sizeof(TestObject), alignof(TestObject), 64);
+    std::vector<std::vector<void*>> objects(NUM_THREADS);
+
+    std::vector<std::thread> threads;
+    for (Size t = 0; t < NUM_THREADS; t++)
+    {
+        threads.emplace_back([&pool, &objects, t]() {
+            for (Size i = 0; i < NUM_OBJECTS; i++)
+            {
+                objects[t].push_back( pool.Allocate() );
+                if (i % 3 == 0)
+                {
+                    pool.Free( objects[t].back() );
+                    objects[t].pop_back();
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    std::set<void*> unique;
+    for (auto &threadObjects : objects)
+    {
+        unique.insert(threadObjects.begin(), threadObjects.end());
+    }
+    REQUIRE( unique.size() == NUM_THREADS * (NUM_OBJECTS - (NUM_OBJECTS + 2) / 3) );
+    REQUIRE( pool.UsedMemory() == unique.size() * pool.ObjectSize() );
+}
@@ -0,0 +1,53 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Memory/PageMemory.h"
+#include "Core/Memory/FreeListAllocator.h"
+
+#include <cstring>
+
+
+using namespace Atuin;
+
+
+TEST_CASE("page memory backings", "[pagememory]") {
+
+    constexpr Size size = 3 * MB + 100;
+
+    for (PageType type : { PageType::MALLOC, PageType::MMAP, PageType::TRANSPARENT_HUGE_PAGES, PageType::HUGE_PAGES })
+    {
+        for (bool prefault : { false, true })
+        {
+            PageBacking backing{ type, prefault };
+
+            Byte *mem = static_cast<Byte*>( PageMemory::Map(size, backing) );
+            REQUIRE( mem != nullptr );
+#ifdef __linux__
+            if (type == PageType::TRANSPARENT_HUGE_PAGES)
+            {
+                REQUIRE( reinterpret_cast<UPtr>(mem) % PageMemory::HUGE_PAGE_SIZE == 0 );
+            }
+#endif
+            std::memset(mem, 0xAB, size);
+            REQUIRE( mem[size - 1] == 0xAB );
+
+            PageMemory::Unmap(mem, size, backing);
+        }
+
+        REQUIRE( PageMemory::ToPageType( PageMemory::ToString(type) ) == type );
+    }
+}
+
+
+TEST_CASE("root allocator on transparent huge pages", "[pagememory]") {
+
+    FreeListAllocator allocator(8_MB, nullptr, PageBacking{ PageType::TRANSPARENT_HUGE_PAGES, false });
+
+    void *a = allocator.Allocate(4_MB, 16);
+    void *b = allocator.Allocate(1_MB, 16);
+    std::memset(a, 1, 4_MB);
+    std::memset(b, 2, 1_MB);
+    allocator.Free(a);
+    allocator.Free(b);
+
+    REQUIRE( allocator.UsedMemory() == 0 );
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Memory/RelocatableHeap.h"
+#include "Core/Memory/FreeListAllocator.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+
+using namespace Atuin;
+
+
+TEST_CASE("relocatable heap handles", "[relocatableheap]") {
+
+    RelocatableHeap heap(1_KB);
+
+    MemoryHandle invalid;
+    REQUIRE( !heap.IsValid(invalid) );
+    REQUIRE( heap.Get(invalid) == nullptr );
+
+    MemoryHandle a = heap.Allocate(100, 8);
+    MemoryHandle b = heap.Allocate(60, 16);
+    REQUIRE( heap.IsValid(a) );
+    REQUIRE( reinterpret_cast<UPtr>(heap.Get(b)) % 16 == 0 );
+    REQUIRE( heap.AllocationSize(a) == 100 );
+    REQUIRE( heap.UsedMemory() == 160 );
+
+    // the freed entry is reused with a new generation, so the old handle stays invalid
+    heap.Free(a);
+    REQUIRE( !heap.IsValid(a) );
+    MemoryHandle c = heap.Allocate(10, 1);
+    REQUIRE( c.index == a.index );
+    REQUIRE( c != a );
+    REQUIRE( !heap.IsValid(a) );
+    REQUIRE( heap.IsValid(c) );
+
+    heap.Clear();
+    REQUIRE( !heap.IsValid(b) );
+    REQUIRE( !heap.IsValid(c) );
+    REQUIRE( heap.UsedMemory() == 0 );
+    REQUIRE( heap.FragmentedMemory() == 0 );
+}
+
+
+TEST_CASE("relocatable heap incremental defragmentation", "[relocatableheap]") {
+
+    FreeListAllocator parent(1_MB);
+    RelocatableHeap heap(64_KB, &parent);
+
+    // every block is filled with its own index
+    std::vector<MemoryHandle> handles;
+    for (Size i = 0; i < 64; i++)
+    {
+        MemoryHandle handle = heap.Allocate(256, 16);
+        std::memset(heap.Get(handle), (int)i, 256);
+        handles.push_back(handle);
+    }
+    REQUIRE( heap.IsCompact() );
+
+    // free every other block
+    for (Size i = 0; i < 64; i += 2)
+    {
+        heap.Free(handles[i]);
+    }
+    REQUIRE( !heap.IsCompact() );
+    REQUIRE( heap.FragmentedMemory() == 32 * 256 );
+
+    // moves are bounded by the per call budget
+    Size numSteps = 0;
+    while (!heap.IsCompact())
+    {
+        Size moved = heap.Defragment(1_KB);
+        REQUIRE( moved <= 1_KB );
+        numSteps++;
+    }
+    REQUIRE( numSteps == 8 );
+    REQUIRE( heap.FragmentedMemory() == 0 );
+
+    for (Size i = 1; i < 64; i += 2)
+    {
+        const Byte *data = static_cast<const Byte*>(heap.Get(handles[i]));
+        REQUIRE( reinterpret_cast<UPtr>(data) % 16 == 0 );
+        REQUIRE( data[0] == i );
+        REQUIRE( data[255] == i );
+    }
+}
+
+
+TEST_CASE("relocatable heap compacts when full", "[relocatableheap]") {
+
+    RelocatableHeap heap(4_KB);
+
+    std::vector<MemoryHandle> handles;
+    for (Size i = 0; i < 16; i++)
+    {
+        handles.push_back( heap.Allocate(256, 8) );
+    }
+    REQUIRE_THROWS_AS( heap.Allocate(1, 1), std::overflow_error );
+
+    for (Size i = 0; i < 16; i += 2)
+    {
+        heap.Free(handles[i]);
+    }
+
+    // enough free bytes in total but no single gap is large enough
+    MemoryHandle large = heap.Allocate(2_KB, 8);
+    REQUIRE( heap.IsValid(large) );
+    REQUIRE( heap.IsCompact() );
+    REQUIRE( heap.UsedMemory() == 4_KB );
+}
+
+
+TEST_CASE("relocatable heap pinned blocks", "[relocatableheap]") {
+
+    RelocatableHeap heap(4_KB);
+
+    MemoryHandle a = heap.Allocate(128, 8);
+    MemoryHandle b = heap.Allocate(128, 8);
+    MemoryHandle c = heap.Allocate(128, 8);
+    void *pinnedAddress = heap.Get(b);
+
+    heap.Pin(b);
+    heap.Free(a);
+    heap.Defragment(4_KB);
+
+    // the pinned block keeps its address and the gap in front of it stays open
+    REQUIRE( heap.Get(b) == pinnedAddress );
+    REQUIRE( heap.IsCompact() );
+    REQUIRE( heap.FragmentedMemory() == 128 );
+
+    // once unpinned the gap is closed
+    heap.Unpin(b);
+    REQUIRE( !heap.IsCompact() );
+    heap.Defragment(4_KB);
+    REQUIRE( heap.Get(b) != pinnedAddress );
+    REQUIRE( heap.FragmentedMemory() == 0 );
+    REQUIRE( heap.IsValid(c) );
+}
@@ -0,0 +1,124 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Memory/SizeClassAllocator.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+using namespace Atuin;
+
+
+TEST_CASE("allocate from size classes", "[sizeclassallocator]") {
+
+    SizeClassAllocator allocator(1_MB);
+
+    void *a = allocator.Allocate(1, 1);
+    void *b = allocator.Allocate(16, 8);
+    void *c = allocator.Allocate(17, 8);
+    void *d = allocator.Allocate(1024, 16);
+
+    REQUIRE( allocator.UsedMemory() == 16 + 16 + 32 + 1024 );
+    REQUIRE( allocator.Owns(a) );
+    REQUIRE( allocator.Owns(d) );
+    REQUIRE( reinterpret_cast<UPtr>(b) % 8 == 0 );
+    REQUIRE( reinterpret_cast<UPtr>(d) % 16 == 0 );
+
+    allocator.Free(a);
+    allocator.Free(b);
+    allocator.Free(c);
+    allocator.Free(d);
+
+    REQUIRE( allocator.UsedMemory() == 0 );
+}
+
+TEST_CASE("reuse freed chunks", "[sizeclassallocator]") {
+
+    SizeClassAllocator allocator(1_MB);
+
+    void *a = allocator.Allocate(100, 8);
+    allocator.Free(a);
+    void *b = allocator.Allocate(120, 8);
+
+    REQUIRE( a == b );
+}
+
+TEST_CASE("exhaust a size class", "[sizeclassallocator]") {
+
+    SizeClassAllocator allocator(SizeClassAllocator::NUM_SIZE_CLASSES * SizeClassAllocator::MAX_CHUNK_SIZE);
+
+    void *a = allocator.TryAllocate(1024, 8);
+
+    REQUIRE( a != nullptr );
+    REQUIRE( allocator.TryAllocate(1024, 8) == nullptr );
+    REQUIRE_THROWS( allocator.Allocate(1024, 8) );
+    REQUIRE( allocator.TryAllocate(512, 8) != nullptr );
+
+    allocator.Clear();
+
+    REQUIRE( allocator.UsedMemory() == 0 );
+    REQUIRE( allocator.TryAllocate(1024, 8) == a );
+}
+
+TEST_CASE("cache chunks per thread", "[sizeclassallocator]") {
+
+    SizeClassAllocator allocator(1_MB, nullptr, 4);
+
+    void *a = allocator.Allocate(16, 8);
+
+    // a whole batch is moved into the thread cache
+    REQUIRE( allocator.UsedMemory() == 4 * 16 );
+
+    allocator.Free(a);
+    REQUIRE( allocator.Allocate(16, 8) == a );
+
+    SECTION("release cache on thread exit")
+    {
+        std::thread worker([&](){
+
+            void *b = allocator.Allocate(32, 8);
+            allocator.Free(b);
+        });
+        worker.join();
+
+        REQUIRE( allocator.UsedMemory() == 4 * 16 );
+    }
+}
+
+
+TEST_CASE("threads exiting while the allocator is destroyed", "[sizeclassallocator]") {
+
+    auto allocator = std::make_unique<SizeClassAllocator>(1_MB, nullptr, 4);
+
+    std::atomic<bool> exit = false;
+    std::atomic<int> numCached = 0;
+    std::vector<std::thread> workers;
+    for (int i = 0; i < 4; i++)
+    {
+        workers.emplace_back([&](){
+
+            allocator->Free( allocator->Allocate(16, 8) );
+            numCached++;
+            while (!exit)
+            {
+                std::this_thread::yield();
+            }
+        });
+    }
+    while (numCached < 4)
+    {
+        std::this_thread::yield();
+    }
+
+    // the caches are either released before the allocator dies or detached by its destructor
+    exit = true;
+    allocator.reset();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    SUCCEED();
+}
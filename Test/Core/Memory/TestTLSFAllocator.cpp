@@ -0,0 +1,130 @@
+#include <catch2/catch.hpp>
+
+#include "Core/Memory/TLSFAllocator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+using namespace Atuin;
+
+
+TEST_CASE("tlsf allocate and free", "[tlsfallocator]") {
+
+    TLSFAllocator allocator(1_MB);
+
+    void *a = allocator.Allocate(10, 8);
+    void *b = allocator.Allocate(1000, 8);
+    void *c = allocator.Allocate(100000, 8);
+
+    REQUIRE( allocator.UsedMemory() > 0 );
+    REQUIRE( reinterpret_cast<UPtr>(a) % 16 == 0 );
+    REQUIRE( reinterpret_cast<UPtr>(b) % 16 == 0 );
+    REQUIRE( reinterpret_cast<UPtr>(c) % 16 == 0 );
+
+    allocator.Free(b);
+    allocator.Free(a);
+    allocator.Free(c);
+
+    REQUIRE( allocator.UsedMemory() == 0 );
+}
+
+TEST_CASE("tlsf over aligned allocations", "[tlsfallocator]") {
+
+    TLSFAllocator allocator(1_MB);
+
+    void *a = allocator.Allocate(24, 8);
+    void *b = allocator.Allocate(100, 64);
+    void *c = allocator.Allocate(3000, 128);
+
+    REQUIRE( reinterpret_cast<UPtr>(b) % 64 == 0 );
+    REQUIRE( reinterpret_cast<UPtr>(c) % 128 == 0 );
+
+    allocator.Free(a);
+    allocator.Free(b);
+    allocator.Free(c);
+
+    REQUIRE( allocator.UsedMemory() == 0 );
+}
+
+TEST_CASE("tlsf merges freed blocks", "[tlsfallocator]") {
+
+    TLSFAllocator allocator(1_MB);
+
+    std::vector<void*> ptrs;
+    for (Size i = 0; i < 512; i++)
+    {
+        ptrs.push_back( allocator.Allocate(1000, 8) );
+    }
+
+    // free every other block first, then the rest
+    for (Size i = 0; i < ptrs.size(); i += 2)
+    {
+        allocator.Free(ptrs[i]);
+    }
+    for (Size i = 1; i < ptrs.size(); i += 2)
+    {
+        allocator.Free(ptrs[i]);
+    }
+
+    REQUIRE( allocator.UsedMemory() == 0 );
+    // only possible if all blocks were merged back into one
+    REQUIRE_NOTHROW( allocator.Free( allocator.Allocate(900_KB, 8) ) );
+}
+
+TEST_CASE("tlsf throws when out of memory", "[tlsfallocator]") {
+
+    TLSFAllocator allocator(64_KB);
+
+    REQUIRE_THROWS( allocator.Allocate(64_KB, 8) );
+    REQUIRE_NOTHROW( allocator.Allocate(32_KB, 8) );
+    REQUIRE_THROWS( allocator.Allocate(32_KB, 8) );
+
+    allocator.Clear();
+
+    REQUIRE( allocator.UsedMemory() == 0 );
+    REQUIRE_NOTHROW( allocator.Allocate(32_KB, 8) );
+}
+
+TEST_CASE("tlsf random allocations do not overlap", "[tlsfallocator]") {
+
+    TLSFAllocator allocator(16_MB);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<Size> sizeDist(1, 4096);
+    std::vector<std::pair<Byte*, Size>> live;
+
+    for (Size i = 0; i < 10000; i++)
+    {
+        if (live.empty() || rng() % 2 == 0)
+        {
+            Size size = sizeDist(rng);
+            Byte *mem = static_cast<Byte*>( allocator.Allocate(size, 16) );
+            std::memset(mem, (int)(i & 0xFF), size);
+            live.push_back( {mem, size} );
+        }
+        else
+        {
+            Size idx = rng() % live.size();
+            allocator.Free( live[idx].first );
+            live[idx] = live.back();
+            live.pop_back();
+        }
+    }
+
+    // each block still holds its own fill pattern -> no allocation overlapped another one
+    std::sort(live.begin(), live.end());
+    for (Size i = 1; i < live.size(); i++)
+    {
+        REQUIRE( live[i-1].first + live[i-1].second <= live[i].first );
+    }
+
+    for (auto &[mem, size] : live)
+    {
+        allocator.Free(mem);
+    }
+
+    REQUIRE( allocator.UsedMemory() == 0 );
+}